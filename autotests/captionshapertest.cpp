@@ -0,0 +1,188 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecaptionshaper.h"
+
+#include <QFontMetrics>
+#include <QSignalSpy>
+#include <QTest>
+#include <QTextLayout>
+
+namespace SierraBreeze
+{
+
+    //* shaping of very long, complex script captions
+    class CaptionShaperTest: public QObject
+    {
+
+        Q_OBJECT
+
+        private Q_SLOTS:
+
+        //* shaping and eliding the whole caption, as done before the shaper
+        void uncapped_data( void );
+        void uncapped( void );
+
+        //* shaping with the caption capped to the width budget
+        void capped_data( void );
+        void capped( void );
+
+        //* capped caption keeps head and tail, without splitting surrogate pairs
+        void budget_data( void );
+        void budget( void );
+
+        //* long captions are shaped on the worker threads, keeping the previous layout meanwhile
+        void asynchronous( void );
+
+        private:
+
+        //* available width, in pixels
+        enum { Width = 800 };
+
+        //* caption length, in characters
+        enum { CaptionLength = 10*1024 };
+
+        //* captions, repeating given sample up to the caption length
+        static QString caption( const QString& sample );
+
+        //* cjk, rtl and mixed captions with emoji
+        static void addCaptions( void );
+
+    };
+
+    //__________________________________________________________________
+    QString CaptionShaperTest::caption( const QString& sample )
+    {
+        QString out;
+        out.reserve( CaptionLength + sample.size() );
+        while( out.size() < CaptionLength ) out.append( sample );
+        return out;
+    }
+
+    //__________________________________________________________________
+    void CaptionShaperTest::addCaptions( void )
+    {
+        QTest::addColumn<QString>( "text" );
+
+        // japanese and chinese
+        QTest::newRow( "cjk" ) << caption( QString::fromUtf8( "東京都の天気予報と週間天気。北京市朝阳区新闻" ) );
+
+        // hebrew and arabic
+        QTest::newRow( "rtl" ) << caption( QString::fromUtf8( "שלום עולם - مرحبا بالعالم - " ) );
+
+        // both directions, with emoji outside of the basic plane
+        QTest::newRow( "mixed" ) << caption( QString::fromUtf8( "Inbox 😀 受信トレイ مرحبا 🎉 - " ) );
+    }
+
+    //__________________________________________________________________
+    void CaptionShaperTest::uncapped_data( void )
+    { addCaptions(); }
+
+    //__________________________________________________________________
+    void CaptionShaperTest::uncapped( void )
+    {
+        QFETCH( QString, text );
+        const QFont font;
+        const QFontMetrics fm( font );
+
+        QBENCHMARK
+        {
+            QTextLayout layout( text, font );
+            layout.beginLayout();
+            const QTextLine line( layout.createLine() );
+            layout.endLayout();
+
+            if( line.naturalTextWidth() > Width ) fm.elidedText( text, Qt::ElideMiddle, Width );
+        }
+    }
+
+    //__________________________________________________________________
+    void CaptionShaperTest::capped_data( void )
+    { addCaptions(); }
+
+    //__________________________________________________________________
+    void CaptionShaperTest::capped( void )
+    {
+        QFETCH( QString, text );
+        const QFont font;
+
+        QBENCHMARK { CaptionShaper::shape( text, font, Width ); }
+    }
+
+    //__________________________________________________________________
+    void CaptionShaperTest::budget_data( void )
+    { addCaptions(); }
+
+    //__________________________________________________________________
+    void CaptionShaperTest::budget( void )
+    {
+        QFETCH( QString, text );
+        const QFont font;
+        const QFontMetrics fm( font );
+
+        const CaptionShaper::Layout layout( CaptionShaper::shape( text, font, Width ) );
+        QVERIFY( layout.matches( text, font, Width ) );
+        QVERIFY( !layout.elided.isEmpty() );
+
+        // what could be visible, plus the ellipsis and a surrogate pair moved across the cut
+        const int budget( 16 + 4*Width/qMax( 1, fm.averageCharWidth() ) );
+        QVERIFY( layout.elided.size() <= budget + 2 );
+
+        // capped caption still overflows, so that it is elided the same way as the whole one
+        QVERIFY( layout.naturalWidth > Width );
+
+        // elided in the middle
+        QVERIFY( layout.elided.startsWith( text.left( 2 ) ) );
+        QVERIFY( layout.elided.contains( QChar( 0x2026 ) ) );
+
+        // surrogate pairs are kept whole
+        for( int i = 0; i < layout.elided.size(); ++i )
+        {
+            const QChar c( layout.elided.at( i ) );
+            if( c.isHighSurrogate() ) QVERIFY( i + 1 < layout.elided.size() && layout.elided.at( ++i ).isLowSurrogate() );
+            else QVERIFY( !c.isLowSurrogate() );
+        }
+    }
+
+    //__________________________________________________________________
+    void CaptionShaperTest::asynchronous( void )
+    {
+        CaptionShaper shaper;
+        QSignalSpy spy( &shaper, &CaptionShaper::shaped );
+        const QFont font;
+
+        // nothing to show yet, shaped in place
+        const QString first( QStringLiteral( "Konsole" ) );
+        QCOMPARE( shaper.layout( first, font, Width ).text, first );
+
+        // long caption, previous layout is kept until the job is done
+        const QString second( caption( QString::fromUtf8( "東京都の天気予報と週間天気。" ) ) );
+        QCOMPARE( shaper.layout( second, font, Width ).text, first );
+
+        QVERIFY( spy.wait() );
+        QVERIFY( shaper.layout().matches( second, font, Width ) );
+        QCOMPARE( shaper.layout( second, font, Width ).text, second );
+    }
+
+}
+
+QTEST_MAIN( SierraBreeze::CaptionShaperTest )
+
+#include "captionshapertest.moc"
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecolortransition.h"
+
+#include <KColorUtils>
+
+#include <QTest>
+
+namespace SierraBreeze
+{
+
+    //* precomputed transitions against the exact color mix
+    class ColorTransitionTest: public QObject
+    {
+
+        Q_OBJECT
+
+        private Q_SLOTS:
+
+        void mix_data( void );
+        void mix( void );
+
+        void fade( void );
+
+        private:
+
+        /**
+        largest channel error allowed. Progress is rounded to the nearest of the 64 steps,
+        which moves each channel by at most 255/128, plus one for rounding to integer channels
+        */
+        enum { MaxError = 3 };
+
+        //* largest channel difference between two colors
+        static int distance( const QColor& first, const QColor& second )
+        {
+            return qMax(
+                qMax( qAbs( first.red() - second.red() ), qAbs( first.green() - second.green() ) ),
+                qMax( qAbs( first.blue() - second.blue() ), qAbs( first.alpha() - second.alpha() ) ) );
+        }
+
+    };
+
+    //__________________________________________________________________
+    void ColorTransitionTest::mix_data( void )
+    {
+        QTest::addColumn<QColor>( "from" );
+        QTest::addColumn<QColor>( "to" );
+
+        QTest::newRow( "black to white" ) << QColor( Qt::black ) << QColor( Qt::white );
+        QTest::newRow( "white to black" ) << QColor( Qt::white ) << QColor( Qt::black );
+        QTest::newRow( "red to blue" ) << QColor( Qt::red ) << QColor( Qt::blue );
+        QTest::newRow( "inactive to active titlebar" ) << QColor( 71, 80, 87 ) << QColor( 214, 210, 208 );
+        QTest::newRow( "transparent to opaque" ) << QColor( 61, 174, 233, 0 ) << QColor( 61, 174, 233 );
+        QTest::newRow( "same color" ) << QColor( 49, 54, 59 ) << QColor( 49, 54, 59 );
+    }
+
+    //__________________________________________________________________
+    void ColorTransitionTest::mix( void )
+    {
+        QFETCH( QColor, from );
+        QFETCH( QColor, to );
+
+        const ColorTransition transition( ColorTransition::mix( from, to ) );
+        QVERIFY( transition.isValid() );
+        QVERIFY( transition.matches( from, to ) );
+
+        // both ends are exact
+        QCOMPARE( transition.at( 0 ), from );
+        QCOMPARE( transition.at( 1 ), to );
+
+        // progress out of range is clamped
+        QCOMPARE( transition.at( -1 ), from );
+        QCOMPARE( transition.at( 2 ), to );
+
+        // in between, within the error bound
+        const int samples = 1000;
+        int maxError = 0;
+        for( int i = 0; i <= samples; ++i )
+        {
+            const qreal progress( qreal( i )/samples );
+            maxError = qMax( maxError, distance( transition.at( progress ), KColorUtils::mix( from, to, progress ) ) );
+        }
+
+        QVERIFY2( maxError <= MaxError, qPrintable( QStringLiteral( "channel error %1 exceeds %2" ).arg( maxError ).arg( int( MaxError ) ) ) );
+    }
+
+    //__________________________________________________________________
+    void ColorTransitionTest::fade( void )
+    {
+        const QColor color( 61, 174, 233, 200 );
+        const ColorTransition transition( ColorTransition::fade( color ) );
+        QVERIFY( transition.matches( color ) );
+
+        QCOMPARE( transition.at( 0 ).alpha(), 0 );
+        QCOMPARE( transition.at( 1 ), color );
+
+        const int samples = 1000;
+        for( int i = 0; i <= samples; ++i )
+        {
+            const qreal progress( qreal( i )/samples );
+            const QColor faded( transition.at( progress ) );
+            QCOMPARE( faded.rgb(), color.rgb() );
+            QVERIFY( qAbs( faded.alpha() - qRound( color.alpha()*progress ) ) <= MaxError );
+        }
+    }
+
+}
+
+QTEST_GUILESS_MAIN( SierraBreeze::ColorTransitionTest )
+
+#include "colortransitiontest.moc"
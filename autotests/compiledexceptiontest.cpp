@@ -0,0 +1,207 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecompiledexception.h"
+
+#include <QTest>
+
+#include <limits>
+
+namespace SierraBreeze
+{
+
+    //* batch matching of compiled exceptions over the classes and titles of all windows
+    class CompiledExceptionTest: public QObject
+    {
+
+        Q_OBJECT
+
+        private Q_SLOTS:
+
+        //* each pattern kind matches as documented
+        void matches_data( void );
+        void matches( void );
+
+        //* parallel and serial evaluation give the same results
+        void parallel( void );
+
+        /**
+        serial and parallel evaluation, below, at and well above the threshold.
+        Parallel evaluation only pays off once the number of evaluations outweighs dispatching to the thread pool
+        */
+        void matchAll_data( void );
+        void matchAll( void );
+
+        private:
+
+        //* exceptions, a quarter of them on window title, with all pattern kinds
+        static QVector<CompiledException> exceptions( int count );
+
+        //* distinct window classes, several windows per application
+        static QStringList classes( int windows );
+
+        //* distinct window titles
+        static QStringList titles( int windows );
+
+        //* compiled exception for given type, kind and pattern
+        static CompiledException exception( int type, int kind, const QString& pattern );
+
+    };
+
+    //__________________________________________________________________
+    CompiledException CompiledExceptionTest::exception( int type, int kind, const QString& pattern )
+    {
+        // settings are backed by an in-memory configuration
+        InternalSettingsPtr settings( new InternalSettings( KSharedConfig::openConfig( QString(), KConfig::SimpleConfig ) ) );
+        settings->setExceptionType( type );
+        settings->setExceptionPatternKind( kind );
+        settings->setExceptionPattern( pattern );
+        return CompiledException::compile( settings );
+    }
+
+    //__________________________________________________________________
+    QVector<CompiledException> CompiledExceptionTest::exceptions( int count )
+    {
+        QVector<CompiledException> out;
+        for( int i = 0; i < count; ++i )
+        {
+            if( i%4 == 0 ) out.append( exception( InternalSettings::ExceptionWindowTitle, InternalSettings::ExceptionPatternRegExp, QStringLiteral( "^Document %1 - " ).arg( i ) ) );
+            else switch( i%3 )
+            {
+                case 0: out.append( exception( InternalSettings::ExceptionWindowClassName, InternalSettings::ExceptionPatternRegExp, QStringLiteral( "^org\\.kde\\.app%1( |$)" ).arg( i ) ) ); break;
+                case 1: out.append( exception( InternalSettings::ExceptionWindowClassName, InternalSettings::ExceptionPatternLiteral, QStringLiteral( "app%1 " ).arg( i ) ) ); break;
+                default: out.append( exception( InternalSettings::ExceptionWindowClassName, InternalSettings::ExceptionPatternGlob, QStringLiteral( "org.kde.app%1 *" ).arg( i ) ) ); break;
+            }
+        }
+
+        return out;
+    }
+
+    //__________________________________________________________________
+    QStringList CompiledExceptionTest::classes( int windows )
+    {
+        QStringList out;
+        for( int i = 0; i < qMax( 1, windows/4 ); ++i )
+        { out.append( QStringLiteral( "org.kde.app%1 App%1" ).arg( i ) ); }
+        return out;
+    }
+
+    //__________________________________________________________________
+    QStringList CompiledExceptionTest::titles( int windows )
+    {
+        QStringList out;
+        for( int i = 0; i < windows; ++i )
+        { out.append( QStringLiteral( "Document %1 - App%2" ).arg( i ).arg( i/4 ) ); }
+        return out;
+    }
+
+    //__________________________________________________________________
+    void CompiledExceptionTest::matches_data( void )
+    {
+        QTest::addColumn<int>( "kind" );
+        QTest::addColumn<QString>( "pattern" );
+        QTest::addColumn<QString>( "value" );
+        QTest::addColumn<bool>( "expected" );
+
+        const int regExp( InternalSettings::ExceptionPatternRegExp );
+        const int literal( InternalSettings::ExceptionPatternLiteral );
+        const int glob( InternalSettings::ExceptionPatternGlob );
+
+        QTest::newRow( "regexp" ) << regExp << QStringLiteral( "^kon.ole" ) << QStringLiteral( "konsole konsole" ) << true;
+        QTest::newRow( "regexp, no match" ) << regExp << QStringLiteral( "^sole" ) << QStringLiteral( "konsole konsole" ) << false;
+        QTest::newRow( "regexp without metacharacters" ) << regExp << QStringLiteral( "sole" ) << QStringLiteral( "konsole konsole" ) << true;
+        QTest::newRow( "literal, anywhere" ) << literal << QStringLiteral( "kde" ) << QStringLiteral( "org.kde.dolphin" ) << true;
+        QTest::newRow( "literal, dot is plain" ) << literal << QStringLiteral( "o.g" ) << QStringLiteral( "org.kde.dolphin" ) << false;
+        QTest::newRow( "glob, whole value" ) << glob << QStringLiteral( "org.*.dolph?n" ) << QStringLiteral( "org.kde.dolphin" ) << true;
+        QTest::newRow( "glob, prefix only" ) << glob << QStringLiteral( "org.kde" ) << QStringLiteral( "org.kde.dolphin" ) << false;
+    }
+
+    //__________________________________________________________________
+    void CompiledExceptionTest::matches( void )
+    {
+        QFETCH( int, kind );
+        QFETCH( QString, pattern );
+        QFETCH( QString, value );
+        QFETCH( bool, expected );
+
+        QCOMPARE( exception( InternalSettings::ExceptionWindowClassName, kind, pattern ).matches( value ), expected );
+    }
+
+    //__________________________________________________________________
+    void CompiledExceptionTest::parallel( void )
+    {
+        const QVector<CompiledException> exceptions( this->exceptions( 300 ) );
+        const QStringList classes( this->classes( 500 ) );
+        const QStringList titles( this->titles( 500 ) );
+
+        const QVector<QBitArray> serial( CompiledException::matchAll( exceptions, classes, titles, std::numeric_limits<int>::max() ) );
+        const QVector<QBitArray> parallel( CompiledException::matchAll( exceptions, classes, titles, 0 ) );
+        QCOMPARE( parallel, serial );
+
+        // one bit per value of the exception type. Exception i matches value i only, if there is one
+        for( int i = 0; i < exceptions.size(); ++i )
+        {
+            const int values( exceptions[i].type == InternalSettings::ExceptionWindowTitle ? titles.size() : classes.size() );
+            QCOMPARE( serial[i].size(), values );
+            QCOMPARE( serial[i].count( true ), i < values ? 1 : 0 );
+            if( i < values ) QVERIFY( serial[i].testBit( i ) );
+        }
+    }
+
+    //__________________________________________________________________
+    void CompiledExceptionTest::matchAll_data( void )
+    {
+        QTest::addColumn<int>( "windows" );
+        QTest::addColumn<int>( "exceptionCount" );
+        QTest::addColumn<bool>( "parallel" );
+
+        // 10 exceptions over 25 windows: 10*( 6 + 25 ) evaluations
+        QTest::newRow( "small, serial" ) << 25 << 10 << false;
+        QTest::newRow( "small, parallel" ) << 25 << 10 << true;
+
+        // 64 exceptions over 50 windows: 64*( 12 + 50 ) evaluations, close to the threshold
+        QTest::newRow( "threshold, serial" ) << 50 << 64 << false;
+        QTest::newRow( "threshold, parallel" ) << 50 << 64 << true;
+
+        // 300 exceptions over 500 windows: 300*( 125 + 500 ) evaluations
+        QTest::newRow( "500 windows, serial" ) << 500 << 300 << false;
+        QTest::newRow( "500 windows, parallel" ) << 500 << 300 << true;
+    }
+
+    //__________________________________________________________________
+    void CompiledExceptionTest::matchAll( void )
+    {
+        QFETCH( int, windows );
+        QFETCH( int, exceptionCount );
+        QFETCH( bool, parallel );
+
+        const QVector<CompiledException> exceptions( this->exceptions( exceptionCount ) );
+        const QStringList classes( this->classes( windows ) );
+        const QStringList titles( this->titles( windows ) );
+        const int threshold( parallel ? 0 : std::numeric_limits<int>::max() );
+
+        QBENCHMARK { CompiledException::matchAll( exceptions, classes, titles, threshold ); }
+    }
+
+}
+
+QTEST_GUILESS_MAIN( SierraBreeze::CompiledExceptionTest )
+
+#include "compiledexceptiontest.moc"
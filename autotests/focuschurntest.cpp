@@ -0,0 +1,203 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezefocuschurn.h"
+
+#include <QTest>
+#include <QVector>
+
+namespace SierraBreeze
+{
+
+    //* repaints while cycling focus through windows, as decorations do for each transition
+    class FocusChurnTest: public QObject
+    {
+
+        Q_OBJECT
+
+        private Q_SLOTS:
+
+        //* focus churn cuts repaints down to one per deactivation
+        void cyclingRepaints_data( void );
+        void cyclingRepaints( void );
+
+        //* activation is animated again once focus has settled
+        void settled( void );
+
+        //* cost of one transition
+        void transition( void );
+
+        private:
+
+        //* animation duration and frame interval, in ms
+        enum
+        {
+            Duration = 150,
+            FrameInterval = 16,
+            Frames = Duration/FrameInterval
+        };
+
+        //* state of one simulated window
+        struct Window
+        {
+            bool deferred = false;
+            qint64 deferredSince = 0;
+        };
+
+        /**
+        cycle focus through windows, one activation every interval, and count repaints.
+        Animations cost one repaint per frame, snapping costs one, deferring costs none.
+        Churn detection is disabled when no tracker is given
+        */
+        static int repaints( FocusChurn*, int windows, int steps, int interval, int* animatedActivations );
+
+    };
+
+    //__________________________________________________________________
+    int FocusChurnTest::repaints( FocusChurn* churn, int windows, int steps, int interval, int* animatedActivations )
+    {
+
+        QVector<Window> states( windows );
+        int count = 0;
+        *animatedActivations = 0;
+
+        // deferred activations that expired while still active are animated
+        auto settle = [&count, animatedActivations]( Window& window, qint64 now )
+        {
+            if( !window.deferred || now < window.deferredSince + Duration ) return;
+            window.deferred = false;
+            count += Frames;
+            ++*animatedActivations;
+        };
+
+        qint64 now = 0;
+        for( int step = 0; step < steps; ++step, now += interval )
+        {
+
+            if( step > 0 )
+            {
+                Window& previous( states[( step - 1 )%windows] );
+                settle( previous, now );
+
+                const FocusChurn::Transition transition( churn ? churn->transition( false, Duration, now ) : FocusChurn::Animate );
+                if( transition == FocusChurn::Snap || previous.deferred ) count += 1;
+                else count += Frames;
+                previous.deferred = false;
+            }
+
+            Window& current( states[step%windows] );
+            const FocusChurn::Transition transition( churn ? churn->transition( true, Duration, now ) : FocusChurn::Animate );
+            if( transition == FocusChurn::Defer )
+            {
+                current.deferred = true;
+                current.deferredSince = now;
+            } else {
+                count += Frames;
+                ++*animatedActivations;
+            }
+
+        }
+
+        // focus settles on the last window
+        settle( states[( steps - 1 )%windows], now + Duration );
+        return count;
+
+    }
+
+    //__________________________________________________________________
+    void FocusChurnTest::cyclingRepaints_data( void )
+    {
+        QTest::addColumn<int>( "windows" );
+        QTest::addColumn<int>( "steps" );
+        QTest::addColumn<bool>( "detectChurn" );
+        QTest::addColumn<int>( "expectedRepaints" );
+        QTest::addColumn<int>( "expectedAnimatedActivations" );
+
+        /*
+        alt+tab through all windows, several times, with steps 30ms apart.
+        Without detection every change is animated: one activation per step, and one deactivation per step but the first.
+        With detection the first two activations and their deactivations animate, the next deactivation
+        and all later ones snap, and only the last activation animates, once focus settles
+        */
+        for( const int windows : { 10, 100 } )
+        {
+            const int steps( 5*windows );
+            QTest::newRow( qPrintable( QStringLiteral( "%1 windows, plain" ).arg( windows ) ) )
+                << windows << steps << false << ( 2*steps - 1 )*Frames << steps;
+            QTest::newRow( qPrintable( QStringLiteral( "%1 windows, churn" ).arg( windows ) ) )
+                << windows << steps << true << 4*Frames + ( steps - 3 ) + Frames << 3;
+        }
+    }
+
+    //__________________________________________________________________
+    void FocusChurnTest::cyclingRepaints( void )
+    {
+        QFETCH( int, windows );
+        QFETCH( int, steps );
+        QFETCH( bool, detectChurn );
+        QFETCH( int, expectedRepaints );
+        QFETCH( int, expectedAnimatedActivations );
+
+        FocusChurn churn;
+        int animatedActivations = 0;
+        const int count( repaints( detectChurn ? &churn : nullptr, windows, steps, 30, &animatedActivations ) );
+
+        QCOMPARE( count, expectedRepaints );
+        QCOMPARE( animatedActivations, expectedAnimatedActivations );
+        QTest::setBenchmarkResult( count, QTest::Events );
+    }
+
+    //__________________________________________________________________
+    void FocusChurnTest::settled( void )
+    {
+        FocusChurn churn;
+
+        // churn
+        qint64 now = 0;
+        for( int i = 0; i < FocusChurn::Activations; ++i, now += 30 )
+        { churn.transition( true, Duration, now ); }
+
+        QCOMPARE( churn.transition( true, Duration, now ), FocusChurn::Defer );
+        QCOMPARE( churn.transition( false, Duration, now ), FocusChurn::Snap );
+
+        // pause longer than one animation period
+        now += 10*Duration;
+        QCOMPARE( churn.transition( false, Duration, now ), FocusChurn::Animate );
+        QCOMPARE( churn.transition( true, Duration, now ), FocusChurn::Animate );
+    }
+
+    //__________________________________________________________________
+    void FocusChurnTest::transition( void )
+    {
+        FocusChurn churn;
+        qint64 now = 0;
+        bool activated = false;
+        QBENCHMARK
+        {
+            activated = !activated;
+            churn.transition( activated, Duration, now += 30 );
+        }
+    }
+
+}
+
+QTEST_GUILESS_MAIN( SierraBreeze::FocusChurnTest )
+
+#include "focuschurntest.moc"
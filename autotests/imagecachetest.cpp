@@ -0,0 +1,171 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezeimagecache.h"
+
+#include <QPainter>
+#include <QRadialGradient>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <cmath>
+
+namespace SierraBreeze
+{
+
+    //* gui thread time spent on a shadow change, rendered in place or on the worker threads
+    class ImageCacheTest: public QObject
+    {
+
+        Q_OBJECT
+
+        private Q_SLOTS:
+
+        void initTestCase( void );
+
+        //* render in the gui thread, as done before the image cache
+        void synchronous_data( void );
+        void synchronous( void );
+
+        //* start rendering on the worker threads, and return
+        void asynchronous_data( void );
+        void asynchronous( void );
+
+        //* rendered image is stored in the cache, and announced in the gui thread
+        void ready( void );
+
+        private:
+
+        /**
+        shadow sized image, rendered the same way as the decoration shadow:
+        a gaussian radial gradient filling a square of twice the shadow size
+        */
+        static QImage render( int shadowSize );
+
+        //* shadow sizes, from the default to the largest allowed by the configuration
+        static void addSizes( void );
+
+        //* unique key for each request, so that nothing is served from the cache
+        static ImageCache::Key nextKey( void )
+        {
+            static quint64 serial = 0;
+            return CacheManager::key( CacheManager::Shadow, ++serial );
+        }
+
+        //* wait for all pending jobs, and deliver their results
+        static void drain( void )
+        {
+            ImageCache::self().threadPool()->waitForDone();
+            QCoreApplication::processEvents();
+        }
+
+    };
+
+    //__________________________________________________________________
+    QImage ImageCacheTest::render( int shadowSize )
+    {
+        QImage image( 2*shadowSize, 2*shadowSize, QImage::Format_ARGB32_Premultiplied );
+        image.fill( Qt::transparent );
+
+        QRadialGradient radialGradient( shadowSize, shadowSize, shadowSize );
+        for( int i = 0; i < 10; ++i )
+        {
+            const qreal x( qreal( i )/9 );
+            radialGradient.setColorAt( x, QColor( 0, 0, 0, std::exp( -x*x/0.15 )*255 ) );
+        }
+
+        QPainter painter( &image );
+        painter.setRenderHint( QPainter::Antialiasing, true );
+        painter.fillRect( image.rect(), radialGradient );
+        painter.end();
+
+        return image;
+    }
+
+    //__________________________________________________________________
+    void ImageCacheTest::initTestCase( void )
+    {
+        // signal argument, as spelled in the signal signature
+        qRegisterMetaType<ImageCache::Key>( "ImageCache::Key" );
+    }
+
+    //__________________________________________________________________
+    void ImageCacheTest::addSizes( void )
+    {
+        QTest::addColumn<int>( "shadowSize" );
+        QTest::newRow( "default" ) << 16;
+        QTest::newRow( "large" ) << 32;
+        QTest::newRow( "largest" ) << 64;
+    }
+
+    //__________________________________________________________________
+    void ImageCacheTest::synchronous_data( void )
+    { addSizes(); }
+
+    //__________________________________________________________________
+    void ImageCacheTest::synchronous( void )
+    {
+        QFETCH( int, shadowSize );
+        QBENCHMARK { CacheManager::self().insert( nextKey(), render( shadowSize ) ); }
+        CacheManager::self().clear();
+    }
+
+    //__________________________________________________________________
+    void ImageCacheTest::asynchronous_data( void )
+    { addSizes(); }
+
+    //__________________________________________________________________
+    void ImageCacheTest::asynchronous( void )
+    {
+        QFETCH( int, shadowSize );
+
+        // the gui thread only queues the job. The previous image stays in use until the new one is ready
+        QBENCHMARK { QVERIFY( ImageCache::self().image( nextKey(), [shadowSize]() { return render( shadowSize ); } ).isNull() ); }
+
+        drain();
+        CacheManager::self().clear();
+    }
+
+    //__________________________________________________________________
+    void ImageCacheTest::ready( void )
+    {
+        QSignalSpy spy( &ImageCache::self(), &ImageCache::imageReady );
+        const ImageCache::Key key( nextKey() );
+        const ImageCache::Renderer renderer( []() { return render( 16 ); } );
+
+        QVERIFY( ImageCache::self().image( key, renderer ).isNull() );
+
+        // a second request for the same key does not start another job
+        QVERIFY( ImageCache::self().image( key, renderer ).isNull() );
+
+        QVERIFY( spy.wait() );
+        QCOMPARE( spy.count(), 1 );
+        QCOMPARE( spy.first().first().value<ImageCache::Key>(), key );
+
+        const QImage image( ImageCache::self().image( key, renderer ) );
+        QCOMPARE( image.size(), QSize( 32, 32 ) );
+        QCOMPARE( CacheManager::self().image( key ), image );
+    }
+
+}
+
+QTEST_GUILESS_MAIN( SierraBreeze::ImageCacheTest )
+
+#include "imagecachetest.moc"
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezepowermonitor.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QProcess>
+#include <QSignalSpy>
+#include <QTest>
+
+namespace SierraBreeze
+{
+
+    //* mock UPower service
+    class UPowerMock: public QObject
+    {
+
+        Q_OBJECT
+        Q_PROPERTY( bool OnBattery MEMBER m_onBattery )
+
+        public:
+
+        bool m_onBattery = true;
+
+    };
+
+    //* mock power-profiles-daemon service
+    class PowerProfilesMock: public QObject
+    {
+
+        Q_OBJECT
+        Q_PROPERTY( QString ActiveProfile MEMBER m_activeProfile )
+
+        public:
+
+        QString m_activeProfile = QStringLiteral( "balanced" );
+
+    };
+
+    //* power monitor against mock services, on a private bus standing for the system bus
+    class PowerMonitorTest: public QObject
+    {
+
+        Q_OBJECT
+
+        private Q_SLOTS:
+
+        void initTestCase( void );
+        void cleanupTestCase( void );
+
+        //* initial state is read from the services
+        void initialState( void );
+
+        //* property changes, in order
+        void changes_data( void );
+        void changes( void );
+
+        private:
+
+        //* emit PropertiesChanged for one property, as the services do
+        void setProperty( const QString& path, const QString& interface, const QString& property, const QVariant& value );
+
+        //* private bus daemon
+        QProcess m_daemon;
+
+        //* connection used by the mock services
+        QDBusConnection m_bus = QDBusConnection( QString() );
+
+        //*@name mock services
+        //@{
+        UPowerMock m_upower;
+        PowerProfilesMock m_powerProfiles;
+        //@}
+
+    };
+
+    //__________________________________________________________________
+    void PowerMonitorTest::initTestCase( void )
+    {
+
+        // private bus, reported by the daemon on its first output line
+        m_daemon.start( QStringLiteral( "dbus-daemon" ), { QStringLiteral( "--session" ), QStringLiteral( "--nofork" ), QStringLiteral( "--print-address" ) } );
+        if( !m_daemon.waitForStarted() ) QSKIP( "dbus-daemon is not available" );
+        QVERIFY( m_daemon.waitForReadyRead() );
+        const QString address( QString::fromLocal8Bit( m_daemon.readLine() ).trimmed() );
+        QVERIFY( !address.isEmpty() );
+
+        // the monitor connects to the system bus on first use
+        qputenv( "DBUS_SYSTEM_BUS_ADDRESS", address.toLocal8Bit() );
+
+        m_bus = QDBusConnection::connectToBus( address, QStringLiteral( "mock" ) );
+        QVERIFY( m_bus.isConnected() );
+
+        QVERIFY( m_bus.registerObject( QStringLiteral( "/org/freedesktop/UPower" ), QStringLiteral( "org.freedesktop.UPower" ),
+            &m_upower, QDBusConnection::ExportAllProperties ) );
+        QVERIFY( m_bus.registerService( QStringLiteral( "org.freedesktop.UPower" ) ) );
+
+        QVERIFY( m_bus.registerObject( QStringLiteral( "/net/hadess/PowerProfiles" ), QStringLiteral( "net.hadess.PowerProfiles" ),
+            &m_powerProfiles, QDBusConnection::ExportAllProperties ) );
+        QVERIFY( m_bus.registerService( QStringLiteral( "net.hadess.PowerProfiles" ) ) );
+
+    }
+
+    //__________________________________________________________________
+    void PowerMonitorTest::cleanupTestCase( void )
+    {
+        QDBusConnection::disconnectFromBus( QStringLiteral( "mock" ) );
+        m_daemon.kill();
+        m_daemon.waitForFinished();
+    }
+
+    //__________________________________________________________________
+    void PowerMonitorTest::setProperty( const QString& path, const QString& interface, const QString& property, const QVariant& value )
+    {
+        auto message( QDBusMessage::createSignal( path, QStringLiteral( "org.freedesktop.DBus.Properties" ), QStringLiteral( "PropertiesChanged" ) ) );
+        message << interface << QVariantMap( { { property, value } } ) << QStringList();
+        QVERIFY( m_bus.send( message ) );
+    }
+
+    //__________________________________________________________________
+    void PowerMonitorTest::initialState( void )
+    {
+        // mock starts on battery. Both replies are asynchronous
+        QSignalSpy spy( &PowerMonitor::self(), &PowerMonitor::lowPowerChanged );
+        QTRY_VERIFY( PowerMonitor::self().isLowPower() );
+        QCOMPARE( spy.count(), 1 );
+    }
+
+    //__________________________________________________________________
+    void PowerMonitorTest::changes_data( void )
+    {
+        QTest::addColumn<QString>( "service" );
+        QTest::addColumn<QString>( "property" );
+        QTest::addColumn<QVariant>( "value" );
+        QTest::addColumn<bool>( "expectedLowPower" );
+        QTest::addColumn<bool>( "expectedSignal" );
+
+        const QString upower( QStringLiteral( "UPower" ) );
+        const QString powerProfiles( QStringLiteral( "PowerProfiles" ) );
+
+        QTest::newRow( "on ac" ) << upower << QStringLiteral( "OnBattery" ) << QVariant( false ) << false << true;
+        QTest::newRow( "power saver" ) << powerProfiles << QStringLiteral( "ActiveProfile" ) << QVariant( QStringLiteral( "power-saver" ) ) << true << true;
+        QTest::newRow( "on battery, already low" ) << upower << QStringLiteral( "OnBattery" ) << QVariant( true ) << true << false;
+        QTest::newRow( "performance, still on battery" ) << powerProfiles << QStringLiteral( "ActiveProfile" ) << QVariant( QStringLiteral( "performance" ) ) << true << false;
+        QTest::newRow( "unrelated property" ) << upower << QStringLiteral( "LidIsClosed" ) << QVariant( false ) << true << false;
+        QTest::newRow( "on ac again" ) << upower << QStringLiteral( "OnBattery" ) << QVariant( false ) << false << true;
+    }
+
+    //__________________________________________________________________
+    void PowerMonitorTest::changes( void )
+    {
+        QFETCH( QString, service );
+        QFETCH( QString, property );
+        QFETCH( QVariant, value );
+        QFETCH( bool, expectedLowPower );
+        QFETCH( bool, expectedSignal );
+
+        QSignalSpy spy( &PowerMonitor::self(), &PowerMonitor::lowPowerChanged );
+        if( service == QLatin1String( "UPower" ) ) setProperty( QStringLiteral( "/org/freedesktop/UPower" ), QStringLiteral( "org.freedesktop.UPower" ), property, value );
+        else setProperty( QStringLiteral( "/net/hadess/PowerProfiles" ), QStringLiteral( "net.hadess.PowerProfiles" ), property, value );
+
+        if( expectedSignal )
+        {
+            QVERIFY( spy.wait() );
+            QCOMPARE( spy.count(), 1 );
+            QCOMPARE( spy.first().first().toBool(), expectedLowPower );
+        } else {
+            // nothing is emitted
+            QVERIFY( !spy.wait( 200 ) );
+        }
+
+        QCOMPARE( PowerMonitor::self().isLowPower(), expectedLowPower );
+    }
+
+}
+
+QTEST_GUILESS_MAIN( SierraBreeze::PowerMonitorTest )
+
+#include "powermonitortest.moc"
@@ -23,6 +23,7 @@
 
 #include "breezesettings.h"
 
+#include <QFlags>
 #include <QSharedPointer>
 #include <QList>
 
@@ -46,6 +47,9 @@ namespace SierraBreeze
         TitleBar_SideMargin = 4,
         TitleBar_ButtonSpacing = 4,
 
+        //* size grip, in units of small spacing
+        SizeGrip_Size = 4,
+
         // shadow dimensions (pixels)
         Shadow_Overlap = 3,
 
@@ -57,6 +61,26 @@ namespace SierraBreeze
         None = 0,
         BorderSize = 1<<4
     };
+
+    //* configuration changes, as emitted by the settings provider
+    enum SettingsChange
+    {
+        NoChanges = 0,
+        ShadowChanged = 1<<0,
+        BordersChanged = 1<<1,
+        ButtonsChanged = 1<<2,
+        AnimationsChanged = 1<<3,
+        AppearanceChanged = 1<<4,
+        ExceptionsChanged = 1<<5,
+        KonsoleChanged = 1<<6,
+        SizeGripChanged = 1<<7,
+        AllChanges = 0xff
+    };
+
+    Q_DECLARE_FLAGS( SettingsChanges, SettingsChange )
+
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS( SierraBreeze::SettingsChanges )
+
 #endif
@@ -21,21 +21,328 @@
  */
 
 #include "breezebutton.h"
+#include "breezecachemanager.h"
+#include "breezeimagecache.h"
+#include "breezepowermonitor.h"
+#include "breezesettingsprovider.h"
+#include "breezestats.h"
 
 #include <KDecoration2/DecoratedClient>
 #include <KColorUtils>
 
+#include <QFontDatabase>
+#include <QFontMetrics>
+#include <QGuiApplication>
 #include <QPainter>
 #include <QPainterPath>
+#include <QtMath>
 
 namespace SierraBreeze
 {
 
-    using KDecoration2::ColorRole;
-    using KDecoration2::ColorGroup;
     using KDecoration2::DecorationButtonType;
 
 
+    //__________________________________________________________________
+    static bool isSierraType( DecorationButtonType type )
+    {
+        switch( type )
+        {
+            case DecorationButtonType::Close:
+            case DecorationButtonType::Maximize:
+            case DecorationButtonType::Minimize:
+            case DecorationButtonType::OnAllDesktops:
+            case DecorationButtonType::Shade:
+            case DecorationButtonType::KeepBelow:
+            case DecorationButtonType::KeepAbove:
+            return true;
+
+            default: return false;
+        }
+    }
+
+    //__________________________________________________________________
+    static void drawSierraIcon( QPainter* painter, DecorationButtonType type, bool active, bool hovered, bool checked, qreal width )
+    {
+        // painter is expected to be scaled to the button's QRect( -1, -1, 20, 20 ) window
+        const QColor& hover_hint_color = StyleResources::hintColor();
+        QPen hint_pen(hover_hint_color);
+        hint_pen.setCapStyle( Qt::RoundCap );
+        hint_pen.setJoinStyle( Qt::MiterJoin );
+        hint_pen.setWidthF( 1.5*qMax((qreal)1.0, 20/width ) );
+
+        switch( type )
+        {
+
+            case DecorationButtonType::Close:
+            {
+              QColor button_color = QColor(242, 80, 86);
+              if (!active)
+                button_color = QColor(199, 199, 199);
+              painter->setBrush( button_color );
+              painter->setPen( Qt::NoPen );
+              painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
+              painter->setBrush( Qt::NoBrush );
+              if ( hovered )
+              {
+                painter->setPen( hint_pen );
+                // painter->setPen(pen);
+                // it's a cross
+                painter->drawLine( QPointF( 6, 6 ), QPointF( 12, 12 ) );
+                painter->drawLine( QPointF( 6, 12 ), QPointF( 12, 6 ) );
+              }
+
+              break;
+            }
+
+            case DecorationButtonType::Maximize:
+            {
+              QColor button_color = QColor(19, 209, 61);
+              if (!active)
+                button_color = QColor(199, 199, 199);
+
+              painter->setBrush( button_color );
+              painter->setPen( Qt::NoPen );
+              // painter->drawEllipse( QRectF( 3, 3, 12, 12 ) );
+              painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
+              painter->setBrush( Qt::NoBrush );
+              if ( hovered )
+              {
+                painter->setPen( hint_pen );
+                // two triangles
+                QPainterPath path1, path2;
+                path1.moveTo(5, 13);
+                path1.lineTo(11, 13);
+                path1.lineTo(5, 7);
+
+                path2.moveTo(13, 5);
+                path2.lineTo(7, 5);
+                path2.lineTo(13, 11);
+
+
+                painter->fillPath(path1, QBrush(hover_hint_color));
+                painter->fillPath(path2, QBrush(hover_hint_color));
+              }
+                // if( checked )
+                // {
+                //     pen.setJoinStyle( Qt::RoundJoin );
+                //     painter->setPen( pen );
+
+                //     painter->drawPolygon( QPolygonF()
+                //         << QPointF( 4, 9 )
+                //         << QPointF( 9, 4 )
+                //         << QPointF( 14, 9 )
+                //         << QPointF( 9, 14 ) );
+
+                // } else {
+                //     painter->drawPolyline( QPolygonF()
+                //         << QPointF( 4, 11 )
+                //         << QPointF( 9, 6 )
+                //         << QPointF( 14, 11 ) );
+                // }
+                break;
+            }
+
+            case DecorationButtonType::Minimize:
+            {
+              QColor button_color = QColor(252, 190, 7);
+              if (!active)
+                button_color = QColor(199, 199, 199);
+              painter->setBrush( button_color );
+              painter->setPen( Qt::NoPen );
+              // painter->drawEllipse( QRectF( 3, 3, 12, 12 ) );
+              painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
+              painter->setBrush( Qt::NoBrush );
+              if ( hovered )
+                {
+                  painter->setPen( hint_pen );
+                  // painter->drawLine( QPointF( 6, 9 ), QPointF( 12, 9 ) );
+                  painter->drawLine( QPointF( 5, 9 ), QPointF( 13, 9 ) );
+                }
+                break;
+            }
+
+            case DecorationButtonType::OnAllDesktops:
+            {
+              QColor button_color = QColor(125, 209, 200);
+              if (!active)
+                button_color = QColor(199, 199, 199);
+              painter->setBrush( button_color );
+              painter->setPen( Qt::NoPen );
+              painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
+              if ( hovered || checked )
+              {
+                painter->setBrush(QBrush(hover_hint_color));
+                painter->drawEllipse( QRectF( 6, 6, 6, 6 ) );
+              }
+              painter->setBrush( Qt::NoBrush );
+              break;
+            }
+
+            case DecorationButtonType::Shade:
+            {
+              QColor button_color = QColor(135, 206, 249);
+              if (!active)
+                button_color = QColor(199, 199, 199);
+              painter->setBrush( button_color );
+              painter->setPen( Qt::NoPen );
+              painter->setBrush( button_color );
+              painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
+              painter->setBrush( Qt::NoBrush );
+                if (checked)
+                {
+                    painter->setPen( hint_pen );
+                    painter->drawLine( 4, 5, 14, 5 );
+                    painter->drawPolyline( QPolygonF()
+                        << QPointF( 4, 8 )
+                        << QPointF( 9, 13 )
+                        << QPointF( 14, 8 ) );
+
+                }
+                else if (hovered) {
+                    painter->setPen( hint_pen );
+                    painter->drawLine( 4, 5, 14, 5 );
+                    painter->drawPolyline( QPolygonF()
+                        << QPointF( 4, 13 )
+                        << QPointF( 9, 8 )
+                        << QPointF( 14, 13 ) );
+                }
+
+                break;
+
+            }
+
+            case DecorationButtonType::KeepBelow:
+            {
+              QColor button_color = QColor(255, 137, 241);
+              if (!active)
+                button_color = QColor(199, 199, 199);
+              painter->setBrush( button_color );
+              painter->setPen( Qt::NoPen );
+              painter->setBrush( button_color );
+              painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
+              painter->setBrush( Qt::NoBrush );
+              if (checked || hovered)
+              {
+                painter->setPen( hint_pen );
+                painter->drawPolyline( QPolygonF()
+                                       << QPointF( 4, 5 )
+                                       << QPointF( 9, 10 )
+                                       << QPointF( 14, 5 ) );
+
+                painter->drawPolyline( QPolygonF()
+                                       << QPointF( 4, 9 )
+                                       << QPointF( 9, 14 )
+                                       << QPointF( 14, 9 ) );
+              }
+
+                break;
+
+            }
+
+            case DecorationButtonType::KeepAbove:
+            {
+              QColor button_color = QColor(204, 176, 213);
+              if (!active)
+                button_color = QColor(199, 199, 199);
+              painter->setBrush( button_color );
+              painter->setPen( Qt::NoPen );
+              painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
+              painter->setBrush( Qt::NoBrush );
+              if ( hovered || checked)
+              {
+
+                painter->setPen( hint_pen );
+                QPainterPath path;
+                path.moveTo(9, 6);
+                path.lineTo(5, 12);
+                path.lineTo(13, 12);
+                painter->fillPath(path, QBrush(hover_hint_color));
+              }
+                // painter->drawPolyline( QPolygonF()
+                //     << QPointF( 4, 9 )
+                //     << QPointF( 9, 4 )
+                //     << QPointF( 14, 9 ) );
+
+                // painter->drawPolyline( QPolygonF()
+                //     << QPointF( 4, 13 )
+                //     << QPointF( 9, 8 )
+                //     << QPointF( 14, 13 ) );
+                break;
+            }
+
+            default: break;
+
+        }
+
+    }
+
+    //__________________________________________________________________
+    static QImage renderSprite( DecorationButtonType type, bool active, bool hovered, bool checked, qreal width, qreal devicePixelRatio )
+    {
+        // called from the worker threads, must not access any button
+        const int size( qCeil( width*devicePixelRatio ) );
+        QImage image( size, size, QImage::Format_ARGB32_Premultiplied );
+        image.setDevicePixelRatio( devicePixelRatio );
+        image.fill( Qt::transparent );
+
+        QPainter painter( &image );
+        painter.setRenderHints( QPainter::Antialiasing );
+        painter.scale( width/20, width/20 );
+        painter.translate( 1, 1 );
+        drawSierraIcon( &painter, type, active, hovered, checked, width );
+        painter.end();
+
+        return image;
+    }
+
+    //__________________________________________________________________
+    static ImageCache::Key spriteKey( DecorationButtonType type, bool active, bool hovered, bool checked, qreal width, qreal devicePixelRatio )
+    {
+        return CacheManager::key( CacheManager::ButtonSprite,
+            quint64( qRound( devicePixelRatio*100 ) & 0xffff ) << 32 |
+            quint64( qRound( width*16 ) & 0xffff ) << 16 |
+            quint64( active ) << 10 |
+            quint64( hovered ) << 9 |
+            quint64( checked ) << 8 |
+            quint64( int( type ) & 0xff ) );
+    }
+
+    //__________________________________________________________________
+    void Button::warmUp( const InternalSettingsPtr& defaults )
+    {
+
+        /*
+        decoration settings are not available before the first decoration,
+        so the grid unit is estimated the way KDecoration2 computes it, from the title font.
+        A wrong guess only costs unused sprites
+        */
+        const QFontMetrics fm( QFontDatabase::systemFont( QFontDatabase::TitleFont ) );
+        const qreal width( fm.boundingRect( QLatin1Char( 'M' ) ).height() + defaults->buttonSize() );
+        const qreal devicePixelRatio( qApp->devicePixelRatio() );
+
+        const DecorationButtonType types[] = {
+            DecorationButtonType::Close,
+            DecorationButtonType::Maximize,
+            DecorationButtonType::Minimize,
+            DecorationButtonType::OnAllDesktops,
+            DecorationButtonType::Shade,
+            DecorationButtonType::KeepBelow,
+            DecorationButtonType::KeepAbove };
+
+        // idle art only, for both active and inactive windows
+        for( const DecorationButtonType type : types )
+        {
+            for( const bool active : { true, false } )
+            {
+                ImageCache::self().image( spriteKey( type, active, false, false, width, devicePixelRatio ),
+                    [type, active, width, devicePixelRatio]()
+                    { return renderSprite( type, active, false, false, width, devicePixelRatio ); } );
+            }
+        }
+
+    }
+
     //__________________________________________________________________
     Button::Button(DecorationButtonType type, Decoration* decoration, QObject* parent)
         : DecorationButton(type, decoration, parent)
@@ -56,8 +363,22 @@ namespace SierraBreeze
 
         // connections
         connect(decoration->client().data(), SIGNAL(iconChanged(QIcon)), this, SLOT(update()));
-        connect(decoration->settings().data(), &KDecoration2::DecorationSettings::reconfigured, this, &Button::reconfigure);
+        connect(SettingsProvider::self(), &SettingsProvider::reconfigured, this, &Button::reconfigure);
         connect( this, &KDecoration2::DecorationButton::hoveredChanged, this, &Button::updateAnimationState );
+        connect( &ImageCache::self(), &ImageCache::imageReady, this,
+            [this]( ImageCache::Key key ) { if( key == m_spriteKey ) update(); } );
+
+        // hover animation already running when entering low power mode jumps to its end state
+        connect( &PowerMonitor::self(), &PowerMonitor::lowPowerChanged, this,
+            [this]()
+            {
+                auto d = qobject_cast<Decoration*>( decoration() );
+                if( d && !d->animationsEnabled() && m_animation->state() == QPropertyAnimation::Running )
+                {
+                    m_animation->stop();
+                    update();
+                }
+            } );
 
         reconfigure();
 
@@ -146,7 +467,21 @@ namespace SierraBreeze
         {
 
             const QRectF iconRect( geometry().topLeft(), m_iconSize );
-            const QPixmap pixmap = decoration()->client().data()->icon().pixmap( m_iconSize );
+
+            // icon pixmaps are shared through the cache manager
+            const QIcon icon( decoration()->client().data()->icon() );
+            const CacheManager::Key key( CacheManager::key( CacheManager::Icon,
+                quint64( qHash( icon.cacheKey() ) ) << 24 |
+                quint64( m_iconSize.width() & 0xfff ) << 12 |
+                quint64( m_iconSize.height() & 0xfff ) ) );
+
+            QPixmap pixmap( CacheManager::self().pixmap( key ) );
+            if( pixmap.isNull() )
+            {
+                pixmap = icon.pixmap( m_iconSize );
+                CacheManager::self().insert( key, pixmap );
+            }
+
             painter->drawPixmap(iconRect.center() - QPoint(pixmap.width()/2, pixmap.height()/2)/pixmap.devicePixelRatio(), pixmap);
 
         } else {
@@ -185,6 +520,31 @@ namespace SierraBreeze
             painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
         }
 
+        // use the pre-rendered sprite when ready, fallback to vector rendering otherwise
+        if( isSierraType( type() ) )
+        {
+            auto d = qobject_cast<Decoration*>( decoration() );
+            const bool active( d->client().data()->isActive() );
+            const bool hovered( isHovered() );
+            const bool checked( isChecked() );
+            const DecorationButtonType type( this->type() );
+            const qreal devicePixelRatio( painter->device()->devicePixelRatioF() );
+
+            m_spriteKey = spriteKey( type, active, hovered, checked, width, devicePixelRatio );
+            const QImage sprite( ImageCache::self().image( m_spriteKey,
+                [type, active, hovered, checked, width, devicePixelRatio]()
+                { return renderSprite( type, active, hovered, checked, width, devicePixelRatio ); } ) );
+
+            if( !sprite.isNull() )
+            {
+                painter->drawImage( QRectF( -1, -1, 20, 20 ), sprite );
+                return;
+            }
+
+            // in reduced quality, the missing sprite is drawn directly without antialiasing, until it is ready
+            if( Stats::self().reducedQuality() ) painter->setRenderHint( QPainter::Antialiasing, false );
+        }
+
         // render mark
         const QColor foregroundColor( this->foregroundColor() );
         if( foregroundColor.isValid() )
@@ -201,217 +561,18 @@ namespace SierraBreeze
             auto d = qobject_cast<Decoration*>( decoration() );
             auto c = d->client().data();
 
-            const auto hover_hint_color = QColor(41, 43, 50, 200);
-            QPen hint_pen(hover_hint_color);
-            hint_pen.setCapStyle( Qt::RoundCap );
-            hint_pen.setJoinStyle( Qt::MiterJoin );
-            hint_pen.setWidthF( 1.5*qMax((qreal)1.0, 20/width ) );
-
             switch( type() )
             {
 
                 case DecorationButtonType::Close:
-                {
-                  QColor button_color = QColor(242, 80, 86);
-                  if (!c->isActive())
-                    button_color = QColor(199, 199, 199);
-                  painter->setBrush( button_color );
-                  painter->setPen( Qt::NoPen );
-                  painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
-                  painter->setBrush( Qt::NoBrush );
-                  if ( isHovered() )
-                  {
-                    painter->setPen( hint_pen );
-                    // painter->setPen(pen);
-                    // it's a cross
-                    painter->drawLine( QPointF( 6, 6 ), QPointF( 12, 12 ) );
-                    painter->drawLine( QPointF( 6, 12 ), QPointF( 12, 6 ) );
-                  }
-                  painter->setPen( pen );
-
-                  break;
-                }
-
                 case DecorationButtonType::Maximize:
-                {
-                  QColor button_color = QColor(19, 209, 61);
-                  if (!c->isActive())
-                    button_color = QColor(199, 199, 199);
-
-                  painter->setBrush( button_color );
-                  painter->setPen( Qt::NoPen );
-                  // painter->drawEllipse( QRectF( 3, 3, 12, 12 ) );
-                  painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
-                  painter->setBrush( Qt::NoBrush );
-                  if ( isHovered() )
-                  {
-                    painter->setPen( hint_pen );
-                    // two triangles
-                    QPainterPath path1, path2;
-                    path1.moveTo(5, 13);
-                    path1.lineTo(11, 13);
-                    path1.lineTo(5, 7);
-
-                    path2.moveTo(13, 5);
-                    path2.lineTo(7, 5);
-                    path2.lineTo(13, 11);
-
-
-                    painter->fillPath(path1, QBrush(hover_hint_color));
-                    painter->fillPath(path2, QBrush(hover_hint_color));
-                  }
-                  painter->setPen( pen );
-                    // if( isChecked() )
-                    // {
-                    //     pen.setJoinStyle( Qt::RoundJoin );
-                    //     painter->setPen( pen );
-
-                    //     painter->drawPolygon( QPolygonF()
-                    //         << QPointF( 4, 9 )
-                    //         << QPointF( 9, 4 )
-                    //         << QPointF( 14, 9 )
-                    //         << QPointF( 9, 14 ) );
-
-                    // } else {
-                    //     painter->drawPolyline( QPolygonF()
-                    //         << QPointF( 4, 11 )
-                    //         << QPointF( 9, 6 )
-                    //         << QPointF( 14, 11 ) );
-                    // }
-                    break;
-                }
-
                 case DecorationButtonType::Minimize:
-                {
-                  QColor button_color = QColor(252, 190, 7);
-                  if (!c->isActive())
-                    button_color = QColor(199, 199, 199);
-                  painter->setBrush( button_color );
-                  painter->setPen( Qt::NoPen );
-                  // painter->drawEllipse( QRectF( 3, 3, 12, 12 ) );
-                  painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
-                  painter->setBrush( Qt::NoBrush );
-                  if ( isHovered() )
-                    {
-                      painter->setPen( hint_pen );
-                      // painter->drawLine( QPointF( 6, 9 ), QPointF( 12, 9 ) );
-                      painter->drawLine( QPointF( 5, 9 ), QPointF( 13, 9 ) );
-                    }
-                  painter->setPen( pen );
-                    break;
-                }
-
                 case DecorationButtonType::OnAllDesktops:
-                {
-                  QColor button_color = QColor(125, 209, 200);
-                  if (!c->isActive())
-                    button_color = QColor(199, 199, 199);
-                  painter->setBrush( button_color );
-                  painter->setPen( Qt::NoPen );
-                  painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
-                  if ( isHovered() || isChecked() )
-                  {
-                    painter->setBrush(QBrush(hover_hint_color));
-                    painter->drawEllipse( QRectF( 6, 6, 6, 6 ) );
-                  }
-                  painter->setPen( pen );
-                  painter->setBrush( Qt::NoBrush );
-                  break;
-                }
-
                 case DecorationButtonType::Shade:
-                {
-                  QColor button_color = QColor(135, 206, 249);
-                  if (!c->isActive())
-                    button_color = QColor(199, 199, 199);
-                  painter->setBrush( button_color );
-                  painter->setPen( Qt::NoPen );
-                  painter->setBrush( button_color );
-                  painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
-                  painter->setBrush( Qt::NoBrush );
-                    if (isChecked())
-                    {
-                        painter->setPen( hint_pen );
-                        painter->drawLine( 4, 5, 14, 5 );
-                        painter->drawPolyline( QPolygonF()
-                            << QPointF( 4, 8 )
-                            << QPointF( 9, 13 )
-                            << QPointF( 14, 8 ) );
-
-                    }
-                    else if (isHovered()) {
-                        painter->setPen( hint_pen );
-                        painter->drawLine( 4, 5, 14, 5 );
-                        painter->drawPolyline( QPolygonF()
-                            << QPointF( 4, 13 )
-                            << QPointF( 9, 8 )
-                            << QPointF( 14, 13 ) );
-                    }
-
-                    break;
-
-                }
-
                 case DecorationButtonType::KeepBelow:
-                {
-                  QColor button_color = QColor(255, 137, 241);
-                  if (!c->isActive())
-                    button_color = QColor(199, 199, 199);
-                  painter->setBrush( button_color );
-                  painter->setPen( Qt::NoPen );
-                  painter->setBrush( button_color );
-                  painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
-                  painter->setBrush( Qt::NoBrush );
-                  if (isChecked() || isHovered())
-                  {
-                    painter->setPen( hint_pen );
-                    painter->drawPolyline( QPolygonF()
-                                           << QPointF( 4, 5 )
-                                           << QPointF( 9, 10 )
-                                           << QPointF( 14, 5 ) );
-
-                    painter->drawPolyline( QPolygonF()
-                                           << QPointF( 4, 9 )
-                                           << QPointF( 9, 14 )
-                                           << QPointF( 14, 9 ) );
-                  }
-
-                    break;
-
-                }
-
                 case DecorationButtonType::KeepAbove:
-                {
-                  QColor button_color = QColor(204, 176, 213);
-                  if (!c->isActive())
-                    button_color = QColor(199, 199, 199);
-                  painter->setBrush( button_color );
-                  painter->setPen( Qt::NoPen );
-                  painter->drawEllipse( QRectF( 0, 0, 18, 18 ) );
-                  painter->setBrush( Qt::NoBrush );
-                  if ( isHovered() || isChecked())
-                  {
-
-                    painter->setPen( hint_pen );
-                    QPainterPath path;
-                    path.moveTo(9, 6);
-                    path.lineTo(5, 12);
-                    path.lineTo(13, 12);
-                    painter->fillPath(path, QBrush(hover_hint_color));
-                  }
-                  painter->setPen( pen );
-                    // painter->drawPolyline( QPolygonF()
-                    //     << QPointF( 4, 9 )
-                    //     << QPointF( 9, 4 )
-                    //     << QPointF( 14, 9 ) );
-
-                    // painter->drawPolyline( QPolygonF()
-                    //     << QPointF( 4, 13 )
-                    //     << QPointF( 9, 8 )
-                    //     << QPointF( 14, 13 ) );
-                    break;
-                }
-
+                drawSierraIcon( painter, type(), c->isActive(), isHovered(), isChecked(), width );
+                break;
 
                 case DecorationButtonType::ApplicationMenu:
                 {
@@ -442,6 +603,36 @@ namespace SierraBreeze
 
     }
 
+    //__________________________________________________________________
+    QColor Button::mix( ColorTransition& transition, const QColor& from, const QColor& to ) const
+    {
+
+        // colors move at each frame while the decoration fades, the table would be rebuilt every time
+        auto d = qobject_cast<Decoration*>( decoration() );
+        if( d->isAnimating() ) return KColorUtils::mix( from, to, m_opacity );
+
+        if( !transition.matches( from, to ) ) transition = ColorTransition::mix( from, to );
+        return transition.at( m_opacity );
+
+    }
+
+    //__________________________________________________________________
+    QColor Button::fade( ColorTransition& transition, const QColor& color ) const
+    {
+
+        auto d = qobject_cast<Decoration*>( decoration() );
+        if( d->isAnimating() )
+        {
+            QColor faded( color );
+            faded.setAlpha( color.alpha()*m_opacity );
+            return faded;
+        }
+
+        if( !transition.matches( color ) ) transition = ColorTransition::fade( color );
+        return transition.at( m_opacity );
+
+    }
+
     //__________________________________________________________________
     QColor Button::foregroundColor( void ) const
     {
@@ -464,7 +655,7 @@ namespace SierraBreeze
 
         } else if( m_animation->state() == QPropertyAnimation::Running ) {
 
-            return KColorUtils::mix( d->fontColor(), d->titleBarColor(), m_opacity );
+            return mix( m_foregroundTransition, d->fontColor(), d->titleBarColor() );
 
         } else if( isHovered() ) {
 
@@ -488,10 +679,9 @@ namespace SierraBreeze
 
         }
 
-        auto c = d->client().data();
         if( isPressed() ) {
 
-            if( type() == DecorationButtonType::Close ) return c->color( ColorGroup::Warning, ColorRole::Foreground );
+            if( type() == DecorationButtonType::Close ) return d->styleResources().warningColor();
             else return KColorUtils::mix( d->titleBarColor(), d->fontColor(), 0.3 );
 
         } else if( ( type() == DecorationButtonType::KeepBelow || type() == DecorationButtonType::KeepAbove ) && isChecked() ) {
@@ -505,27 +695,23 @@ namespace SierraBreeze
                 if( d->internalSettings()->outlineCloseButton() )
                 {
 
-                    return KColorUtils::mix( d->fontColor(), c->color( ColorGroup::Warning, ColorRole::Foreground ).lighter(), m_opacity );
+                    return mix( m_backgroundTransition, d->fontColor(), d->styleResources().warningHoverColor() );
 
                 } else {
 
-                    QColor color( c->color( ColorGroup::Warning, ColorRole::Foreground ).lighter() );
-                    color.setAlpha( color.alpha()*m_opacity );
-                    return color;
+                    return fade( m_backgroundTransition, d->styleResources().warningHoverColor() );
 
                 }
 
             } else {
 
-                QColor color( d->fontColor() );
-                color.setAlpha( color.alpha()*m_opacity );
-                return color;
+                return fade( m_backgroundTransition, d->fontColor() );
 
             }
 
         } else if( isHovered() ) {
 
-            if( type() == DecorationButtonType::Close ) return c->color( ColorGroup::Warning, ColorRole::Foreground ).lighter();
+            if( type() == DecorationButtonType::Close ) return d->styleResources().warningHoverColor();
             else return d->fontColor();
 
         } else if( type() == DecorationButtonType::Close && d->internalSettings()->outlineCloseButton() ) {
@@ -555,7 +741,7 @@ namespace SierraBreeze
     {
 
         auto d = qobject_cast<Decoration*>(decoration());
-        if( !(d && d->internalSettings()->animationsEnabled() ) ) return;
+        if( !(d && d->animationsEnabled() ) ) return;
 
         m_animation->setDirection( hovered ? QPropertyAnimation::Forward : QPropertyAnimation::Backward );
         if( m_animation->state() != QPropertyAnimation::Running ) m_animation->start();
@@ -24,6 +24,7 @@
 */
 #include <KDecoration2/DecorationButton>
 #include "breezedecoration.h"
+#include "breezeimagecache.h"
 
 #include <QHash>
 #include <QImage>
@@ -50,6 +51,9 @@ namespace SierraBreeze
         //* button creation
         static Button *create(KDecoration2::DecorationButtonType type, KDecoration2::Decoration *decoration, QObject *parent);
 
+        //* pre-render the default button art, for given default settings
+        static void warmUp( const InternalSettingsPtr& );
+
         //* render
         virtual void paint(QPainter *painter, const QRect &repaintRegion) override;
 
@@ -121,6 +125,12 @@ namespace SierraBreeze
         QColor backgroundColor( void ) const;
         //@}
 
+        //*@name hover animation colors, from precomputed transitions
+        //@{
+        QColor mix( ColorTransition&, const QColor&, const QColor& ) const;
+        QColor fade( ColorTransition&, const QColor& ) const;
+        //@}
+
         Flag m_flag = FlagNone;
 
         //* active state change animation
@@ -134,6 +144,15 @@ namespace SierraBreeze
 
         //* active state change opacity
         qreal m_opacity = 0;
+
+        //*@name hover animation colors
+        //@{
+        mutable ColorTransition m_foregroundTransition;
+        mutable ColorTransition m_backgroundTransition;
+        //@}
+
+        //* key of the sprite last requested for painting
+        mutable ImageCache::Key m_spriteKey = 0;
     };
 
 } // namespace
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecachemanager.h"
+#include "breezestats.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QSocketNotifier>
+#include <QStringList>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace SierraBreeze
+{
+
+    //* global budget, in bytes
+    static const int CacheBudget = 32*1024*1024;
+
+    //* minimum delay between two purges on memory pressure (ms)
+    static const int PressurePurgeInterval = 10000;
+
+    //__________________________________________________________________
+    class CacheManager::Entry
+    {
+        public:
+
+        //* constructor
+        Entry( qint64* usage, qint64 bytes ):
+            m_usage( usage ),
+            m_bytes( bytes )
+        { *m_usage += m_bytes; }
+
+        //* destructor
+        ~Entry()
+        { *m_usage -= m_bytes; }
+
+        QImage image;
+        QPixmap pixmap;
+
+        private:
+
+        qint64* m_usage;
+        qint64 m_bytes;
+    };
+
+    //__________________________________________________________________
+    static qint64 sizeInBytes( const QImage& image )
+    { return qint64( image.bytesPerLine() )*image.height(); }
+
+    //__________________________________________________________________
+    static qint64 sizeInBytes( const QPixmap& pixmap )
+    { return qint64( pixmap.width() )*pixmap.height()*pixmap.depth()/8; }
+
+    //__________________________________________________________________
+    CacheManager& CacheManager::self( void )
+    {
+        // allocated once, and never deleted, see shutdown
+        static CacheManager* manager( new CacheManager() );
+        return *manager;
+    }
+
+    //__________________________________________________________________
+    CacheManager::CacheManager( void ):
+        m_cache( CacheBudget )
+    {
+
+        for( auto& usage : m_usage )
+        { usage = 0; }
+
+        watchMemoryPressure();
+
+        // low memory monitor
+        QDBusConnection::systemBus().connect(
+            QStringLiteral( "org.freedesktop.LowMemoryMonitor" ),
+            QStringLiteral( "/org/freedesktop/LowMemoryMonitor" ),
+            QStringLiteral( "org.freedesktop.LowMemoryMonitor" ),
+            QStringLiteral( "LowMemoryWarning" ),
+            this, SLOT(lowMemoryWarning(uchar)) );
+
+        // purge on request
+        QDBusConnection::sessionBus().registerObject( QStringLiteral( "/SierraBreezeCache" ), this, QDBusConnection::ExportScriptableSlots );
+
+        // release everything while the application still exists
+        connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &CacheManager::shutdown );
+
+    }
+
+    //__________________________________________________________________
+    CacheManager::~CacheManager()
+    { shutdown(); }
+
+    //__________________________________________________________________
+    void CacheManager::shutdown( void )
+    {
+
+        QDBusConnection::sessionBus().unregisterObject( QStringLiteral( "/SierraBreezeCache" ) );
+
+        delete m_pressureNotifier;
+        m_pressureNotifier = nullptr;
+
+        #ifdef Q_OS_LINUX
+        if( m_pressureFd >= 0 ) ::close( m_pressureFd );
+        #endif
+        m_pressureFd = -1;
+
+        clear();
+
+    }
+
+    //__________________________________________________________________
+    QImage CacheManager::image( Key key )
+    {
+        const Entry* entry( m_cache.object( key ) );
+        return entry ? entry->image : QImage();
+    }
+
+    //__________________________________________________________________
+    void CacheManager::insert( Key key, const QImage& image )
+    {
+        const qint64 bytes( sizeInBytes( image ) );
+        auto entry( new Entry( &m_usage[kind( key )], bytes ) );
+        entry->image = image;
+
+        // entries larger than the budget are deleted right away
+        m_cache.insert( key, entry, int( qMin<qint64>( bytes, CacheBudget + 1 ) ) );
+    }
+
+    //__________________________________________________________________
+    QPixmap CacheManager::pixmap( Key key )
+    {
+        const Entry* entry( m_cache.object( key ) );
+        return entry ? entry->pixmap : QPixmap();
+    }
+
+    //__________________________________________________________________
+    void CacheManager::insert( Key key, const QPixmap& pixmap )
+    {
+        const qint64 bytes( sizeInBytes( pixmap ) );
+        auto entry( new Entry( &m_usage[kind( key )], bytes ) );
+        entry->pixmap = pixmap;
+        m_cache.insert( key, entry, int( qMin<qint64>( bytes, CacheBudget + 1 ) ) );
+    }
+
+    //__________________________________________________________________
+    void CacheManager::account( Kind kind, qint64 bytes )
+    {
+        m_usage[kind] += bytes;
+        m_outsideUsage += bytes;
+
+        // what is left of the budget goes to the cached images
+        m_cache.setMaxCost( int( qBound<qint64>( 0, CacheBudget - m_outsideUsage, CacheBudget ) ) );
+
+        // images held outside exceed the budget by themselves. They are released on the next event loop turn,
+        // not while their owner is still updating them, and at most once per purge interval
+        if( m_outsideUsage > CacheBudget && !m_purgePending )
+        {
+            m_purgePending = true;
+            QTimer::singleShot( 0, this, [this]() { m_purgePending = false; memoryPressure(); } );
+        }
+    }
+
+    //__________________________________________________________________
+    void CacheManager::clear( void )
+    { m_cache.clear(); }
+
+    //__________________________________________________________________
+    void CacheManager::purge( void )
+    {
+        qCInfo( SIERRABREEZE ) << "purging caches." << qPrintable( usageReport() );
+        clear();
+        emit purged();
+    }
+
+    //__________________________________________________________________
+    QString CacheManager::usageReport( void ) const
+    {
+        static const char* names[] = { "", "shadows", "button sprites", "gradient strips", "icons", "caption masks" };
+
+        QStringList out;
+        for( int kind = Shadow; kind < KindCount; ++kind )
+        { out.append( QStringLiteral( "%1: %2kB" ).arg( QLatin1String( names[kind] ) ).arg( m_usage[kind]/1024 ) ); }
+
+        return out.join( QStringLiteral( ", " ) );
+    }
+
+    //__________________________________________________________________
+    QString CacheManager::statistics( void ) const
+    { return Stats::self().toString(); }
+
+    //__________________________________________________________________
+    void CacheManager::lowMemoryWarning( uchar level )
+    { if( level > 0 ) purge(); }
+
+    //__________________________________________________________________
+    void CacheManager::memoryPressure( void )
+    {
+        // a stall keeps triggering until memory is reclaimed, purging again meanwhile only costs re-rendering
+        if( m_pressurePurgeTimer.isValid() && m_pressurePurgeTimer.elapsed() < PressurePurgeInterval ) return;
+        m_pressurePurgeTimer.start();
+        purge();
+    }
+
+    //__________________________________________________________________
+    void CacheManager::watchMemoryPressure( void )
+    {
+        #ifdef Q_OS_LINUX
+
+        /*
+        systemd passes the pressure file and trigger to use in the environment.
+        Otherwise the system wide pressure file is used, with a 200ms stall in 2s threshold
+        */
+        QByteArray path( qgetenv( "MEMORY_PRESSURE_WATCH" ) );
+        QByteArray trigger( QByteArray::fromBase64( qgetenv( "MEMORY_PRESSURE_WRITE" ) ) );
+
+        // explicitly disabled
+        if( path == "/dev/null" ) return;
+
+        if( path.isEmpty() )
+        {
+            path = "/proc/pressure/memory";
+            trigger = QByteArray( "some 200000 2000000" ).append( '\0' );
+        }
+
+        m_pressureFd = ::open( path.constData(), O_RDWR|O_NONBLOCK|O_CLOEXEC );
+        if( m_pressureFd < 0 ) return;
+
+        if( !trigger.isEmpty() && ::write( m_pressureFd, trigger.constData(), trigger.size() ) < 0 )
+        {
+            ::close( m_pressureFd );
+            m_pressureFd = -1;
+            return;
+        }
+
+        // pressure events are reported as priority data
+        m_pressureNotifier = new QSocketNotifier( m_pressureFd, QSocketNotifier::Exception, this );
+        connect( m_pressureNotifier, SIGNAL(activated(int)), SLOT(memoryPressure()) );
+
+        #endif
+    }
+
+}
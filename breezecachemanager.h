@@ -0,0 +1,167 @@
+#ifndef breezecachemanager_h
+#define breezecachemanager_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QCache>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+
+class QSocketNotifier;
+
+namespace SierraBreeze
+{
+
+    /**
+    storage for all decoration image caches, with a global byte budget
+    and least recently used eviction. Everything is purged on memory pressure,
+    low memory warnings, or on request over D-Bus.
+    The manager is never deleted: it releases its images and system resources
+    when the application is about to quit, so that nothing outlives the application
+    */
+    class CacheManager: public QObject
+    {
+
+        Q_OBJECT
+        Q_CLASSINFO( "D-Bus Interface", "org.kde.SierraBreeze.CacheManager" )
+
+        public:
+
+        //* key
+        using Key = quint64;
+
+        //* cached image kinds, stored in the upper bits of the keys
+        enum Kind
+        {
+            Shadow = 1,
+            ButtonSprite,
+            GradientStrip,
+            Icon,
+            CaptionMask,
+            KindCount
+        };
+
+        //* key, from kind and kind specific parameters packed in the lower 56 bits
+        static Key key( Kind kind, quint64 parameters )
+        { return ( quint64( kind ) << 56 ) | ( parameters & ( ( quint64( 1 ) << 56 ) - 1 ) ); }
+
+        //* kind, from key
+        static Kind kind( Key key )
+        { return Kind( key >> 56 ); }
+
+        //* singleton
+        static CacheManager& self( void );
+
+        //* destructor
+        virtual ~CacheManager();
+
+        //*@name images. Gui thread only
+        //@{
+        QImage image( Key );
+        void insert( Key, const QImage& );
+        //@}
+
+        //*@name pixmaps. Gui thread only
+        //@{
+        QPixmap pixmap( Key );
+        void insert( Key, const QPixmap& );
+        //@}
+
+        /**
+        account for images of given kind held outside of the cache.
+        They count against the budget: cached images are evicted to make room for them,
+        and everything is purged if they exceed it by themselves
+        */
+        void account( Kind kind, qint64 bytes );
+
+        //* bytes used by images of given kind
+        qint64 usage( Kind kind ) const
+        { return m_usage[kind]; }
+
+        //* remove everything, without notice
+        void clear( void );
+
+        Q_SIGNALS:
+
+        //* emitted after a purge. Images held outside of the cache must be released
+        void purged( void );
+
+        public Q_SLOTS:
+
+        //* remove everything, and ask for images held outside of the cache to be released
+        Q_SCRIPTABLE void purge( void );
+
+        //* usage, per kind
+        Q_SCRIPTABLE QString usageReport( void ) const;
+
+        //* paint statistics and rendering quality, as logged
+        Q_SCRIPTABLE QString statistics( void ) const;
+
+        private Q_SLOTS:
+
+        //* low memory monitor warning
+        void lowMemoryWarning( uchar level );
+
+        //* memory pressure event, purges at most once per interval
+        void memoryPressure( void );
+
+        //* release images and system resources before the application goes away
+        void shutdown( void );
+
+        private:
+
+        //* constructor
+        CacheManager( void );
+
+        //* watch pressure stall information, as set up by systemd or from the kernel directly
+        void watchMemoryPressure( void );
+
+        //* cached entry
+        class Entry;
+
+        //* entries
+        QCache<Key, Entry> m_cache;
+
+        //* bytes used, per kind
+        qint64 m_usage[KindCount];
+
+        //* bytes used by images held outside of the cache
+        qint64 m_outsideUsage = 0;
+
+        //* true when a purge is scheduled because images held outside of the cache exceed the budget
+        bool m_purgePending = false;
+
+        //* memory pressure file descriptor
+        int m_pressureFd = -1;
+
+        //* memory pressure notifier
+        QSocketNotifier* m_pressureNotifier = nullptr;
+
+        //* time since the last purge on memory pressure
+        QElapsedTimer m_pressurePurgeTimer;
+
+    };
+
+}
+
+#endif
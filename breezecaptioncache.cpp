@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecaptioncache.h"
+#include "breezecachemanager.h"
+
+#include <QPainter>
+
+namespace SierraBreeze
+{
+
+    //__________________________________________________________________
+    CaptionCache::~CaptionCache()
+    { clear(); }
+
+    //__________________________________________________________________
+    void CaptionCache::paint( QPainter* painter, const QString& text, const QFont& font, const QRect& rect, Qt::Alignment alignment, const QColor& color )
+    {
+
+        if( rect.isEmpty() ) return;
+
+        const qreal devicePixelRatio( painter->device()->devicePixelRatioF() );
+        if( m_mask.isNull() ||
+            text != m_text ||
+            font != m_font ||
+            rect != m_rect ||
+            alignment != m_alignment ||
+            devicePixelRatio != m_devicePixelRatio )
+        {
+            m_text = text;
+            m_font = font;
+            m_rect = rect;
+            m_alignment = alignment;
+            m_devicePixelRatio = devicePixelRatio;
+
+            updateMask( devicePixelRatio );
+            m_color = QColor();
+        }
+
+        if( color != m_color ) updateImage( color );
+        painter->drawImage( rect.topLeft(), m_image );
+
+    }
+
+    //__________________________________________________________________
+    void CaptionCache::clear( void )
+    {
+        m_mask = QImage();
+        m_image = QImage();
+        m_color = QColor();
+        account();
+    }
+
+    //__________________________________________________________________
+    void CaptionCache::account( void )
+    {
+        const qint64 bytes(
+            qint64( m_mask.bytesPerLine() )*m_mask.height() +
+            qint64( m_image.bytesPerLine() )*m_image.height() );
+
+        CacheManager::self().account( CacheManager::CaptionMask, bytes - m_bytes );
+        m_bytes = bytes;
+    }
+
+    //__________________________________________________________________
+    void CaptionCache::updateMask( qreal devicePixelRatio )
+    {
+
+        m_mask = QImage( m_rect.size()*devicePixelRatio, QImage::Format_Alpha8 );
+        m_mask.setDevicePixelRatio( devicePixelRatio );
+        m_mask.fill( Qt::transparent );
+
+        QPainter maskPainter( &m_mask );
+        maskPainter.setFont( m_font );
+        maskPainter.setPen( Qt::white );
+        maskPainter.drawText( QRect( QPoint( 0, 0 ), m_rect.size() ), m_alignment | Qt::TextSingleLine, m_text );
+        maskPainter.end();
+
+        // reuse the tinted image buffer when possible
+        if( m_image.size() != m_mask.size() )
+        {
+            m_image = QImage( m_mask.size(), QImage::Format_ARGB32_Premultiplied );
+            m_image.setDevicePixelRatio( devicePixelRatio );
+        }
+
+        account();
+
+    }
+
+    //__________________________________________________________________
+    void CaptionCache::updateImage( const QColor& color )
+    {
+
+        m_color = color;
+        m_image.setDevicePixelRatio( m_devicePixelRatio );
+        m_image.fill( color );
+
+        // keep the color where the glyphs are
+        QPainter painter( &m_image );
+        painter.setCompositionMode( QPainter::CompositionMode_DestinationIn );
+        painter.drawImage( 0, 0, m_mask );
+        painter.end();
+
+    }
+
+}
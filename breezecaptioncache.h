@@ -0,0 +1,90 @@
+#ifndef breezecaptioncache_h
+#define breezecaptioncache_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QColor>
+#include <QFont>
+#include <QImage>
+#include <QRect>
+#include <QString>
+
+class QPainter;
+
+namespace SierraBreeze
+{
+
+    /**
+    caption, rasterized once as an alpha mask and tinted with the current color.
+    Glyphs are only rendered again when the caption, font, geometry or pixel ratio change,
+    not at each frame of the active state change animation
+    */
+    class CaptionCache
+    {
+
+        public:
+
+        //* destructor
+        ~CaptionCache();
+
+        //* paint caption, already elided to fit in rect, with given color
+        void paint( QPainter*, const QString&, const QFont&, const QRect&, Qt::Alignment, const QColor& );
+
+        //* release images
+        void clear( void );
+
+        private:
+
+        //* render mask
+        void updateMask( qreal devicePixelRatio );
+
+        //* tint mask with given color
+        void updateImage( const QColor& );
+
+        //* report memory used by images to the cache manager
+        void account( void );
+
+        //*@name mask key
+        //@{
+        QString m_text;
+        QFont m_font;
+        QRect m_rect;
+        Qt::Alignment m_alignment;
+        qreal m_devicePixelRatio = 0;
+        //@}
+
+        //* glyphs coverage
+        QImage m_mask;
+
+        //* tinted mask
+        QImage m_image;
+
+        //* color of the tinted mask
+        QColor m_color;
+
+        //* bytes reported to the cache manager
+        qint64 m_bytes = 0;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecaptionshaper.h"
+#include "breezeimagecache.h"
+
+#include <QFontMetrics>
+#include <QTextLayout>
+#include <QtConcurrentRun>
+
+namespace SierraBreeze
+{
+
+    //* captions up to this length are cheap enough to shape in place
+    static const int SyncShapingLength = 128;
+
+    //__________________________________________________________________
+    CaptionShaper::CaptionShaper( QObject* parent ):
+        QObject( parent )
+    {
+        connect( &m_watcher, &QFutureWatcherBase::finished, this, [this]()
+            {
+                // last request was already served in place
+                if( m_layout.matches( m_text, m_font, m_width ) ) return;
+
+                m_layout = m_watcher.result();
+
+                // caption changed again meanwhile
+                if( !m_layout.matches( m_text, m_font, m_width ) ) start();
+
+                emit shaped();
+            } );
+    }
+
+    //__________________________________________________________________
+    CaptionShaper::~CaptionShaper()
+    { m_watcher.waitForFinished(); }
+
+    //__________________________________________________________________
+    const CaptionShaper::Layout& CaptionShaper::layout( const QString& text, const QFont& font, int width )
+    {
+
+        if( m_layout.matches( text, font, width ) ) return m_layout;
+
+        m_text = text;
+        m_font = font;
+        m_width = width;
+
+        // nothing to show yet, or short caption
+        if( m_layout.width < 0 || text.size() <= SyncShapingLength )
+        {
+            m_layout = shape( text, font, width );
+            return m_layout;
+        }
+
+        // keep current layout until the job is done. Finished job will pick up the last request
+        if( !m_watcher.isRunning() ) start();
+        return m_layout;
+
+    }
+
+    //__________________________________________________________________
+    void CaptionShaper::start( void )
+    {
+        const QString text( m_text );
+        const QFont font( m_font );
+        const int width( m_width );
+        m_watcher.setFuture( QtConcurrent::run( ImageCache::self().threadPool(),
+            [text, font, width]() { return shape( text, font, width ); } ) );
+    }
+
+    //__________________________________________________________________
+    CaptionShaper::Layout CaptionShaper::shape( const QString& text, const QFont& font, int width )
+    {
+
+        Layout out;
+        out.text = text;
+        out.font = font;
+        out.width = width;
+
+        /*
+        cap the caption to what could possibly be visible in the available width.
+        Head and tail are kept, since captions are elided in the middle
+        */
+        const QFontMetrics fm( font );
+        const int budget( 16 + 4*qMax( 0, width )/qMax( 1, fm.averageCharWidth() ) );
+        QString capped( text );
+        if( text.size() > budget )
+        {
+            int head( budget/2 );
+            int tail( budget - head );
+
+            // do not split surrogate pairs
+            if( text.at( head ).isLowSurrogate() ) ++head;
+            if( text.at( text.size() - tail ).isLowSurrogate() ) --tail;
+
+            capped = text.left( head ) + QChar( 0x2026 ) + text.right( tail );
+        }
+
+        // shape
+        QTextOption option;
+        option.setWrapMode( QTextOption::NoWrap );
+
+        QTextLayout layout( capped, font );
+        layout.setTextOption( option );
+        layout.beginLayout();
+        QTextLine line( layout.createLine() );
+        layout.endLayout();
+
+        out.naturalWidth = line.isValid() ? line.naturalTextWidth() : 0;
+        out.elided = ( out.naturalWidth <= width ) ? capped : fm.elidedText( capped, Qt::ElideMiddle, width );
+
+        return out;
+
+    }
+
+}
@@ -0,0 +1,112 @@
+#ifndef breezecaptionshaper_h
+#define breezecaptionshaper_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFont>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+
+namespace SierraBreeze
+{
+
+    /**
+    shapes and elides captions on the worker threads.
+    The previous layout is used until the new one is ready
+    */
+    class CaptionShaper: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* constructor
+        explicit CaptionShaper( QObject* parent = nullptr );
+
+        //* destructor
+        virtual ~CaptionShaper();
+
+        //* shaped caption
+        class Layout
+        {
+            public:
+
+            //*@name request
+            //@{
+            QString text;
+            QFont font;
+            int width = -1;
+            //@}
+
+            //* caption, elided to fit in width
+            QString elided;
+
+            //* caption width, before eliding
+            qreal naturalWidth = 0;
+
+            //* true if layout was made for given request
+            bool matches( const QString& text, const QFont& font, int width ) const
+            { return this->width == width && this->text == text && this->font == font; }
+        };
+
+        /**
+        layout for given caption, font and available width.
+        Long captions are shaped asynchronously, and the previous layout is returned meanwhile
+        */
+        const Layout& layout( const QString&, const QFont&, int width );
+
+        //* current layout
+        const Layout& layout( void ) const
+        { return m_layout; }
+
+        //* shape caption. Safe to call from any thread
+        static Layout shape( const QString&, const QFont&, int width );
+
+        Q_SIGNALS:
+
+        //* emitted when an asynchronous layout is ready
+        void shaped( void );
+
+        private:
+
+        //* start shaping on the worker threads
+        void start( void );
+
+        //* current layout
+        Layout m_layout;
+
+        //*@name last request
+        //@{
+        QString m_text;
+        QFont m_font;
+        int m_width = -1;
+        //@}
+
+        //* pending job
+        QFutureWatcher<Layout> m_watcher;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecolortransition.h"
+
+#include <KColorUtils>
+
+namespace SierraBreeze
+{
+
+    //__________________________________________________________________
+    ColorTransition ColorTransition::mix( const QColor& from, const QColor& to )
+    {
+        ColorTransition transition;
+        transition.m_colors.reserve( Steps + 1 );
+        for( int i = 0; i < Steps; ++i )
+        { transition.m_colors.append( KColorUtils::mix( from, to, qreal( i )/Steps ) ); }
+
+        // keep the end color exact
+        transition.m_colors.append( to );
+        return transition;
+    }
+
+    //__________________________________________________________________
+    ColorTransition ColorTransition::fade( const QColor& color )
+    {
+        ColorTransition transition;
+        transition.m_colors.reserve( Steps + 1 );
+        for( int i = 0; i <= Steps; ++i )
+        {
+            QColor faded( color );
+            faded.setAlpha( color.alpha()*i/Steps );
+            transition.m_colors.append( faded );
+        }
+
+        return transition;
+    }
+
+}
@@ -0,0 +1,74 @@
+#ifndef breezecolortransition_h
+#define breezecolortransition_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QColor>
+#include <QVector>
+
+namespace SierraBreeze
+{
+
+    //* colors along an animation, precomputed at fixed resolution
+    class ColorTransition
+    {
+
+        public:
+
+        //* number of steps between start and end colors
+        enum { Steps = 64 };
+
+        //* linear mix between two colors
+        static ColorTransition mix( const QColor& from, const QColor& to );
+
+        //* color faded in from fully transparent
+        static ColorTransition fade( const QColor& color );
+
+        //* true if table holds any color
+        bool isValid( void ) const
+        { return !m_colors.isEmpty(); }
+
+        //* true if table goes between given colors
+        bool matches( const QColor& from, const QColor& to ) const
+        { return isValid() && m_colors.first() == from && m_colors.last() == to; }
+
+        //* true if table fades given color in
+        bool matches( const QColor& color ) const
+        {
+            QColor transparent( color );
+            transparent.setAlpha( 0 );
+            return matches( transparent, color );
+        }
+
+        //* color for given animation progress, in [0,1]
+        QColor at( qreal progress ) const
+        { return m_colors[ qBound( 0, qRound( progress*Steps ), int( Steps ) ) ]; }
+
+        private:
+
+        //* colors, Steps+1 entries, including both ends
+        QVector<QColor> m_colors;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecompiledexception.h"
+
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <numeric>
+
+namespace SierraBreeze
+{
+
+    //__________________________________________________________________
+    CompiledException CompiledException::compile( const InternalSettingsPtr& internalSettings )
+    {
+        CompiledException exception;
+        exception.settings = internalSettings;
+        exception.type = internalSettings->exceptionType();
+        exception.kind = internalSettings->exceptionPatternKind();
+        exception.pattern = internalSettings->exceptionPattern();
+
+        // regular expressions without metacharacters match the same as plain text
+        if( exception.kind == InternalSettings::ExceptionPatternRegExp && isLiteral( exception.pattern ) )
+        { exception.kind = InternalSettings::ExceptionPatternLiteral; }
+
+        if( exception.kind == InternalSettings::ExceptionPatternRegExp )
+        {
+            exception.regExp.setPattern( exception.pattern );
+            exception.regExp.optimize();
+        }
+
+        return exception;
+    }
+
+    //__________________________________________________________________
+    QVector<QBitArray> CompiledException::matchAll( const QVector<CompiledException>& exceptions, const QStringList& classes, const QStringList& titles, int parallelThreshold )
+    {
+
+        // each worker only writes its own result
+        QVector<QBitArray> results( exceptions.size() );
+        QBitArray* resultData( results.data() );
+        auto evaluate = [&exceptions, &classes, &titles, resultData]( int i )
+        {
+            const CompiledException& exception( exceptions[i] );
+            const QStringList& values( exception.type == InternalSettings::ExceptionWindowTitle ? titles:classes );
+            QBitArray& result( resultData[i] );
+            result.resize( values.size() );
+            for( int index = 0; index < values.size(); ++index )
+            { if( exception.matches( values[index] ) ) result.setBit( index ); }
+        };
+
+        QVector<int> indexes( exceptions.size() );
+        std::iota( indexes.begin(), indexes.end(), 0 );
+        if( exceptions.size()*( classes.size() + titles.size() ) > parallelThreshold ) QtConcurrent::blockingMap( indexes, evaluate );
+        else std::for_each( indexes.begin(), indexes.end(), evaluate );
+
+        return results;
+
+    }
+
+    //__________________________________________________________________
+    bool CompiledException::matches( const QString& value ) const
+    {
+        switch( kind )
+        {
+            case InternalSettings::ExceptionPatternLiteral: return value.contains( pattern );
+            case InternalSettings::ExceptionPatternGlob: return globMatches( pattern, value );
+            default:
+            case InternalSettings::ExceptionPatternRegExp: return regExp.match( value ).hasMatch();
+        }
+    }
+
+    //__________________________________________________________________
+    bool CompiledException::isLiteral( const QString& pattern )
+    {
+        static const QString metaCharacters( QStringLiteral( "\\^$.|?*+()[]{}" ) );
+        for( const QChar& character : pattern )
+        { if( metaCharacters.contains( character ) ) return false; }
+
+        return true;
+    }
+
+    //__________________________________________________________________
+    bool CompiledException::globMatches( const QString& pattern, const QString& value )
+    {
+
+        // iterative matching, backtracking to the last star only
+        int p = 0;
+        int v = 0;
+        int star = -1;
+        int starValue = 0;
+        while( v < value.size() )
+        {
+
+            if( p < pattern.size() && ( pattern[p] == QLatin1Char( '?' ) || pattern[p] == value[v] ) )
+            {
+
+                ++p;
+                ++v;
+
+            } else if( p < pattern.size() && pattern[p] == QLatin1Char( '*' ) ) {
+
+                star = p++;
+                starValue = v;
+
+            } else if( star >= 0 ) {
+
+                p = star + 1;
+                v = ++starValue;
+
+            } else return false;
+
+        }
+
+        // only stars may remain
+        while( p < pattern.size() && pattern[p] == QLatin1Char( '*' ) ) ++p;
+        return p == pattern.size();
+
+    }
+
+}
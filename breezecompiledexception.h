@@ -0,0 +1,73 @@
+#ifndef breezecompiledexception_h
+#define breezecompiledexception_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breeze.h"
+
+#include <QBitArray>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace SierraBreeze
+{
+
+    //* exception, with its pattern compiled once
+    class CompiledException
+    {
+        public:
+
+        //* number of pattern evaluations above which batch matching runs in parallel
+        enum { ParallelMatchThreshold = 4096 };
+
+        //* compile pattern of given exception
+        static CompiledException compile( const InternalSettingsPtr& );
+
+        //* true if value matches the exception pattern
+        bool matches( const QString& value ) const;
+
+        /**
+        evaluate each exception once over the distinct values of its type, window classes or titles.
+        Bit i of result n is set if exception n matches value i. Runs in parallel above given number of evaluations
+        */
+        static QVector<QBitArray> matchAll( const QVector<CompiledException>&, const QStringList& classes, const QStringList& titles,
+            int parallelThreshold = ParallelMatchThreshold );
+
+        //* true if pattern has no regular expression metacharacters
+        static bool isLiteral( const QString& );
+
+        //* true if value matches the wildcard pattern as a whole
+        static bool globMatches( const QString& pattern, const QString& value );
+
+        InternalSettingsPtr settings;
+        int type = InternalSettings::ExceptionWindowClassName;
+
+        //* pattern kind, as matched. Regular expressions without metacharacters are matched as literals
+        int kind = InternalSettings::ExceptionPatternRegExp;
+        QString pattern;
+        QRegularExpression regExp;
+    };
+
+}
+
+#endif
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezeconfigblob.h"
+#include "breezeexceptionlist.h"
+
+#include <QColor>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
+
+#include <cstring>
+
+namespace SierraBreeze
+{
+
+    //* file format
+    static const quint32 BlobMagic = 0x53424346;
+    static const quint32 BlobVersion = 3;
+
+    //* blob header
+    struct BlobHeader
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 recordSize;
+        quint32 exceptionCount;
+        qint64 configModified;
+        qint64 configSize;
+        quint32 stringsOffset;
+        quint32 stringsLength;
+    };
+
+    //* settings record. The first one holds the default settings, the others the exceptions, in matching order
+    struct BlobRecord
+    {
+        qint32 shadowStrength;
+        qint32 shadowSize;
+        quint32 shadowColor;
+        qint32 outlineCloseButton;
+        qint32 lowPowerMode;
+        qint32 frameBudget;
+        qint32 borderSize;
+        qint32 titleAlignment;
+        qint32 buttonSize;
+        qint32 buttonSpacing;
+        qint32 buttonHPadding;
+        qint32 drawBorderOnMaximizedWindows;
+        qint32 drawTitleBarSeparator;
+        qint32 drawBackgroundGradient;
+        qint32 drawSizeGrip;
+        qint32 matchColorForTitleBar;
+        qint32 animationsEnabled;
+        qint32 animationsDuration;
+        qint32 hideTitleBar;
+        qint32 enabled;
+        qint32 exceptionType;
+        qint32 exceptionPatternKind;
+        qint32 mask;
+
+        //* exception pattern, in utf16 characters from the start of the strings
+        quint32 patternOffset;
+        quint32 patternLength;
+    };
+
+    //__________________________________________________________________
+    static BlobRecord toRecord( const InternalSettingsPtr& settings, quint32 patternOffset )
+    {
+        BlobRecord record;
+        record.shadowStrength = settings->shadowStrength();
+        record.shadowSize = settings->shadowSize();
+        record.shadowColor = settings->shadowColor().rgba();
+        record.outlineCloseButton = settings->outlineCloseButton();
+        record.lowPowerMode = settings->lowPowerMode();
+        record.frameBudget = settings->frameBudget();
+        record.borderSize = settings->borderSize();
+        record.titleAlignment = settings->titleAlignment();
+        record.buttonSize = settings->buttonSize();
+        record.buttonSpacing = settings->buttonSpacing();
+        record.buttonHPadding = settings->buttonHPadding();
+        record.drawBorderOnMaximizedWindows = settings->drawBorderOnMaximizedWindows();
+        record.drawTitleBarSeparator = settings->drawTitleBarSeparator();
+        record.drawBackgroundGradient = settings->drawBackgroundGradient();
+        record.drawSizeGrip = settings->drawSizeGrip();
+        record.matchColorForTitleBar = settings->matchColorForTitleBar();
+        record.animationsEnabled = settings->animationsEnabled();
+        record.animationsDuration = settings->animationsDuration();
+        record.hideTitleBar = settings->hideTitleBar();
+        record.enabled = settings->enabled();
+        record.exceptionType = settings->exceptionType();
+        record.exceptionPatternKind = settings->exceptionPatternKind();
+        record.mask = settings->mask();
+        record.patternOffset = patternOffset;
+        record.patternLength = settings->exceptionPattern().size();
+        return record;
+    }
+
+    //__________________________________________________________________
+    static InternalSettingsPtr fromRecord( KSharedConfigPtr config, const BlobRecord& record, const QChar* strings )
+    {
+        InternalSettingsPtr settings( new InternalSettings( config ) );
+        settings->setShadowStrength( record.shadowStrength );
+        settings->setShadowSize( record.shadowSize );
+        settings->setShadowColor( QColor::fromRgba( record.shadowColor ) );
+        settings->setOutlineCloseButton( record.outlineCloseButton );
+        settings->setLowPowerMode( record.lowPowerMode );
+        settings->setFrameBudget( record.frameBudget );
+        settings->setBorderSize( record.borderSize );
+        settings->setTitleAlignment( record.titleAlignment );
+        settings->setButtonSize( record.buttonSize );
+        settings->setButtonSpacing( record.buttonSpacing );
+        settings->setButtonHPadding( record.buttonHPadding );
+        settings->setDrawBorderOnMaximizedWindows( record.drawBorderOnMaximizedWindows );
+        settings->setDrawTitleBarSeparator( record.drawTitleBarSeparator );
+        settings->setDrawBackgroundGradient( record.drawBackgroundGradient );
+        settings->setDrawSizeGrip( record.drawSizeGrip );
+        settings->setMatchColorForTitleBar( record.matchColorForTitleBar );
+        settings->setAnimationsEnabled( record.animationsEnabled );
+        settings->setAnimationsDuration( record.animationsDuration );
+        settings->setHideTitleBar( record.hideTitleBar );
+        settings->setEnabled( record.enabled );
+        settings->setExceptionType( record.exceptionType );
+        settings->setExceptionPatternKind( record.exceptionPatternKind );
+        settings->setMask( record.mask );
+        settings->setExceptionPattern( QString( strings + record.patternOffset, record.patternLength ) );
+        return settings;
+    }
+
+    //__________________________________________________________________
+    QString ConfigBlob::fileName( void )
+    { return QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation ) + QStringLiteral( "/sierrabreeze/config.blob" ); }
+
+    //__________________________________________________________________
+    QString ConfigBlob::configFileName( void )
+    { return QStandardPaths::locate( QStandardPaths::GenericConfigLocation, QStringLiteral( "breezerc" ) ); }
+
+    //__________________________________________________________________
+    bool ConfigBlob::write( KSharedConfigPtr config )
+    {
+
+        const QFileInfo configInfo( configFileName() );
+        if( !configInfo.exists() ) return false;
+
+        // resolve settings the same way the decoration does
+        InternalSettingsPtr defaultSettings( new InternalSettings( config ) );
+        defaultSettings->setCurrentGroup( QStringLiteral("Windeco") );
+        defaultSettings->load();
+
+        ExceptionList exceptionList;
+        exceptionList.readConfig( config );
+        const InternalSettingsList& exceptions( exceptionList.get() );
+
+        // records and strings
+        QVector<BlobRecord> records;
+        QString strings;
+        records.append( toRecord( defaultSettings, 0 ) );
+        for( const InternalSettingsPtr& exception : exceptions )
+        {
+            records.append( toRecord( exception, strings.size() ) );
+            strings.append( exception->exceptionPattern() );
+        }
+
+        BlobHeader header;
+        std::memset( &header, 0, sizeof( header ) );
+        header.magic = BlobMagic;
+        header.version = BlobVersion;
+        header.recordSize = sizeof( BlobRecord );
+        header.exceptionCount = exceptions.size();
+        header.configModified = configInfo.lastModified().toMSecsSinceEpoch();
+        header.configSize = configInfo.size();
+        header.stringsOffset = sizeof( BlobHeader ) + records.size()*sizeof( BlobRecord );
+        header.stringsLength = strings.size();
+
+        const QString fileName( ConfigBlob::fileName() );
+        QDir().mkpath( QFileInfo( fileName ).absolutePath() );
+
+        QSaveFile file( fileName );
+        if( !file.open( QIODevice::WriteOnly ) ) return false;
+        file.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+        file.write( reinterpret_cast<const char*>( records.constData() ), records.size()*sizeof( BlobRecord ) );
+        file.write( reinterpret_cast<const char*>( strings.constData() ), strings.size()*sizeof( QChar ) );
+        return file.commit();
+
+    }
+
+    //__________________________________________________________________
+    QByteArray ConfigBlob::load( QByteArray& stamp )
+    {
+
+        QFile file( fileName() );
+        if( !file.open( QIODevice::ReadOnly ) || file.size() < qint64( sizeof( BlobHeader ) ) ) return QByteArray();
+
+        const uchar* data( file.map( 0, file.size() ) );
+        if( !data ) return QByteArray();
+
+        // check format and stamp
+        const BlobHeader& header( *reinterpret_cast<const BlobHeader*>( data ) );
+        const QFileInfo configInfo( configFileName() );
+        if( header.magic != BlobMagic ||
+            header.version != BlobVersion ||
+            header.recordSize != sizeof( BlobRecord ) ||
+            header.configModified != configInfo.lastModified().toMSecsSinceEpoch() ||
+            header.configSize != configInfo.size() ||
+            header.stringsOffset != sizeof( BlobHeader ) + ( header.exceptionCount + 1 )*sizeof( BlobRecord ) ||
+            file.size() != qint64( header.stringsOffset ) + qint64( header.stringsLength )*qint64( sizeof( QChar ) ) )
+        { return QByteArray(); }
+
+        // check string ranges
+        const BlobRecord* records( reinterpret_cast<const BlobRecord*>( data + sizeof( BlobHeader ) ) );
+        for( quint32 i = 0; i <= header.exceptionCount; ++i )
+        {
+            if( quint64( records[i].patternOffset ) + records[i].patternLength > header.stringsLength )
+            { return QByteArray(); }
+        }
+
+        // the blob stamp identifies the configuration it was compiled from
+        stamp = QByteArray( reinterpret_cast<const char*>( &header.configModified ), sizeof( header.configModified ) ) +
+            QByteArray( reinterpret_cast<const char*>( &header.configSize ), sizeof( header.configSize ) );
+
+        // copied out of the mapping, which goes away with the file
+        return QByteArray( reinterpret_cast<const char*>( data ), file.size() );
+
+    }
+
+    //__________________________________________________________________
+    bool ConfigBlob::read( const QByteArray& blob, InternalSettingsPtr& defaultSettings, InternalSettingsList& exceptions )
+    {
+
+        if( blob.isEmpty() ) return false;
+
+        const char* data( blob.constData() );
+        const BlobHeader& header( *reinterpret_cast<const BlobHeader*>( data ) );
+        const BlobRecord* records( reinterpret_cast<const BlobRecord*>( data + sizeof( BlobHeader ) ) );
+        const QChar* strings( reinterpret_cast<const QChar*>( data + header.stringsOffset ) );
+
+        // settings are filled from the records, backed by an empty in-memory configuration so that nothing is parsed
+        const KSharedConfigPtr config( KSharedConfig::openConfig( QString(), KConfig::SimpleConfig ) );
+        defaultSettings = fromRecord( config, records[0], strings );
+
+        exceptions.clear();
+        for( quint32 i = 1; i <= header.exceptionCount; ++i )
+        { exceptions.append( fromRecord( config, records[i], strings ) ); }
+
+        return true;
+
+    }
+
+}
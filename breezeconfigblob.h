@@ -0,0 +1,73 @@
+#ifndef breezeconfigblob_h
+#define breezeconfigblob_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breeze.h"
+
+#include <KSharedConfig>
+
+#include <QByteArray>
+#include <QString>
+
+namespace SierraBreeze
+{
+
+    /**
+    compiled configuration, written by the configuration module next to breezerc.
+    Holds the default settings and the exceptions, already resolved, as fixed size records
+    that the decoration maps in memory and reads without parsing.
+    The blob is stamped with the modification time and size of breezerc, and ignored when stale
+    */
+    class ConfigBlob
+    {
+
+        public:
+
+        //* write blob for the current content of given configuration. Must be called after sync
+        static bool write( KSharedConfigPtr );
+
+        //* read blob into default settings and exceptions, and get the blob stamp. Returns false if missing or stale
+        static bool read( InternalSettingsPtr& defaultSettings, InternalSettingsList& exceptions, QByteArray& stamp )
+        { return read( load( stamp ), defaultSettings, exceptions ); }
+
+        /**
+        checked blob content and stamp, or an empty array if missing or stale.
+        Only plain data is touched, so that it is safe to call from any thread
+        */
+        static QByteArray load( QByteArray& stamp );
+
+        //* read content returned by load() into default settings and exceptions. Returns false if empty. Must be called from the gui thread
+        static bool read( const QByteArray& blob, InternalSettingsPtr& defaultSettings, InternalSettingsList& exceptions );
+
+        private:
+
+        //* blob file
+        static QString fileName( void );
+
+        //* configuration file
+        static QString configFileName( void );
+
+    };
+
+}
+
+#endif
@@ -24,30 +24,32 @@
 #include "breeze.h"
 #include "breezesettingsprovider.h"
 #include "config-breeze.h"
-#include "config/breezeconfigwidget.h"
 
 #include "breezebutton.h"
-#include "breezesizegrip.h"
+#include "breezecachemanager.h"
+#include "breezecaptionshaper.h"
+#include "breezefocuschurn.h"
+#include "breezeimagecache.h"
+#include "breezepowermonitor.h"
+#include "breezeresolutioncache.h"
+#include "breezestats.h"
+#include "breezevisibilitytracker.h"
+#include "breezewindowpropertycache.h"
 
 #include <KDecoration2/DecoratedClient>
 #include <KDecoration2/DecorationButtonGroup>
 #include <KDecoration2/DecorationSettings>
 #include <KDecoration2/DecorationShadow>
 
-#include <KConfigGroup>
-#include <KColorUtils>
-#include <KSharedConfig>
 #include <KPluginFactory>
-#include <KWindowInfo>
 
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QPainter>
+#include <QPolygon>
 #include <QTextStream>
 #include <QTimer>
-#include <QDir>
-
-#if BREEZE_HAVE_X11
-#include <QX11Info>
-#endif
+#include <QtMath>
 
 #include <cmath>
 
@@ -57,26 +59,144 @@ K_PLUGIN_FACTORY_WITH_JSON(
     "breeze.json",
     registerPlugin<SierraBreeze::Decoration>();
     registerPlugin<SierraBreeze::Button>(QStringLiteral("button"));
-    registerPlugin<SierraBreeze::ConfigWidget>(QStringLiteral("kcmodule"));
+    SierraBreeze::Decoration::warmUp();
 )
 
 namespace SierraBreeze
 {
 
-    using KDecoration2::ColorRole;
-    using KDecoration2::ColorGroup;
-
     //________________________________________________________________
     static int g_sDecoCount = 0;
-    static int g_shadowSize = 0;
-    static int g_shadowStrength = 0;
-    static QColor g_shadowColor = Qt::black;
+    static ImageCache::Key g_shadowKey = 0;
     static QSharedPointer<KDecoration2::DecorationShadow> g_sShadow;
 
+    //* delay before matching title exceptions after the caption changed (ms)
+    static const int CaptionMatchDelay = 250;
+
+    //________________________________________________________________
+    static QBrush gradientBrush( int height, const QColor& color, qreal devicePixelRatio )
+    {
+
+        /*
+        the gradient only depends on the titlebar height, color and pixel ratio.
+        It is rendered once in a one pixel wide strip, shared by all decorations,
+        that the texture brush tiles horizontally
+        */
+        const CacheManager::Key key( CacheManager::key( CacheManager::GradientStrip,
+            quint64( qRound( devicePixelRatio*100 ) & 0xfff ) << 44 |
+            quint64( height & 0xfff ) << 32 |
+            quint64( color.rgba() ) ) );
+
+        QImage strip( CacheManager::self().image( key ) );
+        if( strip.isNull() )
+        {
+            strip = QImage( 1, qCeil( height*devicePixelRatio ), QImage::Format_ARGB32_Premultiplied );
+            strip.fill( Qt::transparent );
+
+            QLinearGradient gradient( 0, 0, 0, strip.height() );
+            gradient.setColorAt(0.0, color.lighter( 120 ) );
+            gradient.setColorAt(0.8, color);
+
+            QPainter painter( &strip );
+            painter.fillRect( strip.rect(), gradient );
+            painter.end();
+
+            CacheManager::self().insert( key, strip );
+        }
+
+        // strip is in device pixels
+        QBrush brush( strip );
+        brush.setTransform( QTransform::fromScale( 1, 1/devicePixelRatio ) );
+        return brush;
+
+    }
+
+    //________________________________________________________________
+    static ImageCache::Key shadowKey( const InternalSettingsPtr& internalSettings )
+    {
+        return CacheManager::key( CacheManager::Shadow,
+            quint64( internalSettings->shadowSize() & 0xff ) << 40 |
+            quint64( internalSettings->shadowStrength() & 0xff ) << 32 |
+            quint64( internalSettings->shadowColor().rgba() ) );
+    }
+
+    //________________________________________________________________
+    static QImage renderShadow( int shadowSize, int shadowStrength, const QColor& shadowColor )
+    {
+        // called from the worker threads, must not access any decoration
+        const int shadowOffset = qMax( 6*shadowSize/16, Metrics::Shadow_Overlap*2 );
+
+        // create image
+        QImage image(2*shadowSize, 2*shadowSize, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        // create gradient
+        // gaussian delta function
+        auto alpha = [](qreal x) { return std::exp( -x*x/0.15 ); };
+
+        // color calculation delta function
+        auto gradientStopColor = [](QColor color, int alpha)
+        {
+            color.setAlpha(alpha);
+            return color;
+        };
+
+        QRadialGradient radialGradient( shadowSize, shadowSize, shadowSize );
+        for( int i = 0; i < 10; ++i )
+        {
+            const qreal x( qreal( i )/9 );
+            radialGradient.setColorAt(x,  gradientStopColor( shadowColor, alpha(x)*shadowStrength ) );
+        }
+
+        radialGradient.setColorAt(1, gradientStopColor( shadowColor, 0 ) );
+
+        // fill
+        QPainter painter(&image);
+        painter.setRenderHint( QPainter::Antialiasing, true );
+        painter.fillRect( image.rect(), radialGradient);
+
+        // contrast pixel
+        QRectF innerRect = QRectF(
+            shadowSize - Metrics::Shadow_Overlap, shadowSize - shadowOffset - Metrics::Shadow_Overlap,
+            2*Metrics::Shadow_Overlap, shadowOffset + 2*Metrics::Shadow_Overlap );
+
+        painter.setPen( gradientStopColor( shadowColor, shadowStrength*0.5 ) );
+        painter.setBrush( Qt::NoBrush );
+        painter.drawRoundedRect( innerRect, -0.5 + Metrics::Frame_FrameRadius, -0.5 + Metrics::Frame_FrameRadius );
+
+        // mask out inner rect
+        painter.setPen( Qt::NoPen );
+        painter.setBrush( Qt::black );
+        painter.setCompositionMode(QPainter::CompositionMode_DestinationOut );
+        painter.drawRoundedRect( innerRect, 0.5 + Metrics::Frame_FrameRadius, 0.5 + Metrics::Frame_FrameRadius );
+
+        painter.end();
+
+        return image;
+    }
+
+    //________________________________________________________________
+    static QImage shadowImage( const InternalSettingsPtr& internalSettings )
+    {
+        // image is rendered on the worker threads. Null until it is ready
+        const int shadowSize = internalSettings->shadowSize();
+        const int shadowStrength = internalSettings->shadowStrength();
+        const QColor shadowColor = internalSettings->shadowColor();
+        return ImageCache::self().image( shadowKey( internalSettings ),
+            [shadowSize, shadowStrength, shadowColor]() { return renderShadow( shadowSize, shadowStrength, shadowColor ); } );
+    }
+
+    //________________________________________________________________
+    static bool isKonsoleMainWindow( const WindowPropertyCache::Entry& entry )
+    { return entry.classClass == QByteArray("konsole") && entry.role.startsWith("MainWindow"); }
+
     //________________________________________________________________
     Decoration::Decoration(QObject *parent, const QVariantList &args)
         : KDecoration2::Decoration(parent, args)
         , m_animation( new QPropertyAnimation( this ) )
+        , m_activationTimer( new QTimer( this ) )
+        , m_captionTimer( new QTimer( this ) )
+        , m_captionShaper( new CaptionShaper( this ) )
     {
         g_sDecoCount++;
     }
@@ -84,14 +204,17 @@ namespace SierraBreeze
     //________________________________________________________________
     Decoration::~Decoration()
     {
+        VisibilityTracker::self().unregisterDecoration( m_windowId );
+        WindowPropertyCache::self().unregisterWindow( m_windowId );
+        SettingsProvider::self()->unregisterDecoration( this );
+
         g_sDecoCount--;
         if (g_sDecoCount == 0) {
-            // last deco destroyed, clean up shadow
+            // last deco destroyed, clean up shadow and cached images
             g_sShadow.clear();
+            CacheManager::self().clear();
         }
 
-        deleteSizeGrip();
-
     }
 
     //________________________________________________________________
@@ -100,28 +223,45 @@ namespace SierraBreeze
         if( m_opacity == value ) return;
         m_opacity = value;
         update();
+    }
+
+    //________________________________________________________________
+    bool Decoration::animationsEnabled() const
+    { return m_internalSettings->animationsEnabled() && !Stats::self().reducedQuality() && !lowPowerMode(); }
+
+    //________________________________________________________________
+    bool Decoration::lowPowerMode() const
+    {
+        switch( m_internalSettings->lowPowerMode() )
+        {
+            case InternalSettings::LowPowerAlways: return true;
+            case InternalSettings::LowPowerNever: return false;
 
-        if( m_sizeGrip ) m_sizeGrip->update();
+            default:
+            case InternalSettings::LowPowerAuto:
+            return PowerMonitor::self().isLowPower();
+        }
     }
 
+    //________________________________________________________________
+    bool Decoration::isTransitioning() const
+    { return m_animation->state() == QPropertyAnimation::Running || m_activationTimer->isActive(); }
+
     //________________________________________________________________
     QColor Decoration::titleBarColor() const
     {
 
         auto c = client().data();
 
-        if ( isKonsoleWindow(c) ) {
+        if ( isKonsoleWindow() ) {
             return m_KonsoleTitleBarColor;
         }
 
-        if( hideTitleBar() ) return c->color( ColorGroup::Inactive, ColorRole::TitleBar );
-        else if( m_animation->state() == QPropertyAnimation::Running )
+        if( hideTitleBar() ) return m_resources->titleBarColor( false );
+        else if( isTransitioning() )
         {
-            return KColorUtils::mix(
-                c->color( ColorGroup::Inactive, ColorRole::TitleBar ),
-                c->color( ColorGroup::Active, ColorRole::TitleBar ),
-                m_opacity );
-        } else return c->color( c->isActive() ? ColorGroup::Active : ColorGroup::Inactive, ColorRole::TitleBar );
+            return m_resources->titleBarTransition().at( m_opacity );
+        } else return m_resources->titleBarColor( c->isActive() );
 
     }
 
@@ -131,12 +271,10 @@ namespace SierraBreeze
 
         auto c( client().data() );
         if( !m_internalSettings->drawTitleBarSeparator() ) return QColor();
-        if( m_animation->state() == QPropertyAnimation::Running )
+        if( isTransitioning() )
         {
-            QColor color( c->palette().color( QPalette::Highlight ) );
-            color.setAlpha( color.alpha()*m_opacity );
-            return color;
-        } else if( c->isActive() ) return c->palette().color( QPalette::Highlight );
+            return m_resources->outlineTransition().at( m_opacity );
+        } else if( c->isActive() ) return m_resources->highlightColor();
         else return QColor();
     }
 
@@ -145,29 +283,39 @@ namespace SierraBreeze
     {
 
         auto c = client().data();
-        if( m_animation->state() == QPropertyAnimation::Running )
+        if( isTransitioning() )
         {
-            if ( isKonsoleWindow(c) ) {
-                return KColorUtils::mix(
-                        m_KonsoleTitleBarTextColorInactive,
-                        m_KonsoleTitleBarTextColorActive,
-                        m_opacity );
-            }
-            else {
-                return KColorUtils::mix(
-                        c->color( ColorGroup::Inactive, ColorRole::Foreground ),
-                        c->color( ColorGroup::Active, ColorRole::Foreground ),
-                        m_opacity );
-            }
+            if ( isKonsoleWindow() && m_konsoleFontTransition.isValid() ) return m_konsoleFontTransition.at( m_opacity );
+            else return m_resources->fontTransition().at( m_opacity );
         } else {
-            if ( isKonsoleWindow(c) ) {
+            if ( isKonsoleWindow() ) {
                 return  c->isActive() ? m_KonsoleTitleBarTextColorActive : m_KonsoleTitleBarTextColorInactive;
             } else {
-                return  c->color( c->isActive() ? ColorGroup::Active : ColorGroup::Inactive, ColorRole::Foreground );
+                return  m_resources->fontColor( c->isActive() );
             }
         }
     }
 
+    //________________________________________________________________
+    void Decoration::updateStyleResources()
+    {
+
+        // resolved colors, shared with all decorations using the same palette
+        auto c = client().data();
+        m_resources = StyleResources::get( c );
+
+        // konsole colors are specific to the decoration
+        if( isKonsoleWindow() )
+        {
+            m_konsoleFontTransition = ColorTransition::mix(
+                m_KonsoleTitleBarTextColorInactive,
+                m_KonsoleTitleBarTextColorActive );
+        } else m_konsoleFontTransition = ColorTransition();
+
+        update();
+
+    }
+
     //________________________________________________________________
     void Decoration::init()
     {
@@ -180,6 +328,41 @@ namespace SierraBreeze
         m_animation->setPropertyName( "opacity" );
         m_animation->setEasingCurve( QEasingCurve::InOutQuad );
 
+        // delayed activation animation, when focus changes quickly
+        m_activationTimer->setSingleShot( true );
+        connect( m_activationTimer, &QTimer::timeout, this, [this]()
+            {
+                if( !client().data()->isActive() ) return;
+                m_animation->setDirection( QPropertyAnimation::Forward );
+                if( m_animation->state() != QPropertyAnimation::Running ) m_animation->start();
+            } );
+
+        // title exceptions, matched again when the caption changes
+        m_captionTimer->setSingleShot( true );
+        m_captionTimer->setInterval( CaptionMatchDelay );
+        connect( m_captionTimer, &QTimer::timeout, this, &Decoration::updateTitleSettings );
+
+        // window properties used by exceptions and visibility, fetched once and then kept up to date
+        m_windowId = c->windowId();
+        WindowPropertyCache::self().registerWindow( m_windowId );
+        m_isKonsoleWindow = isKonsoleMainWindow( WindowPropertyCache::self().entry( m_windowId ) );
+        connect(&WindowPropertyCache::self(), &WindowPropertyCache::propertiesChanged, this, &Decoration::updateWindowProperties);
+        SettingsProvider::self()->registerDecoration( this );
+
+        // visibility, used to defer work for hidden windows
+        m_visible = VisibilityTracker::isVisible( this );
+        VisibilityTracker::self().registerDecoration( m_windowId, this );
+        connect(c, &KDecoration2::DecoratedClient::desktopChanged, this, &Decoration::updateVisibility);
+        connect(c, &KDecoration2::DecoratedClient::onAllDesktopsChanged, this, &Decoration::updateVisibility);
+
+        // persisted class matches are verified in the background, and corrected if wrong
+        connect(&ResolutionCache::self(), &ResolutionCache::corrected, this,
+            [this]( const QString& windowClass )
+            {
+                if( windowClass == WindowPropertyCache::self().entry( m_windowId ).windowClass() )
+                { updateSettings( ExceptionsChanged ); }
+            } );
+
         reconfigure();
         updateTitleBar();
         auto s = settings();
@@ -194,24 +377,61 @@ namespace SierraBreeze
         connect(s.data(), &KDecoration2::DecorationSettings::decorationButtonsLeftChanged, this, &Decoration::updateButtonsGeometryDelayed);
         connect(s.data(), &KDecoration2::DecorationSettings::decorationButtonsRightChanged, this, &Decoration::updateButtonsGeometryDelayed);
 
-        // full reconfiguration
-        connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, this, &Decoration::reconfigure);
-        connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, SettingsProvider::self(), &SettingsProvider::reconfigure, Qt::UniqueConnection );
-        connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, this, &Decoration::updateButtonsGeometryDelayed);
+        // reconfiguration
+        // the provider finds what changed, decorations only redo the work needed for it
+        connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, SettingsProvider::self(), &SettingsProvider::reconfigureDelayed, Qt::UniqueConnection );
+        connect(SettingsProvider::self(), &SettingsProvider::reconfigured, this, &Decoration::updateSettings);
 
         connect(c, &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, &Decoration::recalculateBorders);
         connect(c, &KDecoration2::DecoratedClient::maximizedHorizontallyChanged, this, &Decoration::recalculateBorders);
         connect(c, &KDecoration2::DecoratedClient::maximizedVerticallyChanged, this, &Decoration::recalculateBorders);
         connect(c, &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::recalculateBorders);
+        connect(c, &KDecoration2::DecoratedClient::resizeableChanged, this, &Decoration::recalculateBorders);
+        // release the caption images on memory pressure
+        connect(&CacheManager::self(), &CacheManager::purged, this,
+            [this]()
+            {
+                m_captionCache.clear();
+                update(titleBar());
+            }
+        );
+
+        // repaint when quality is reduced or restored
+        connect(&Stats::self(), &Stats::reducedQualityChanged, this, [this]() { update(); } );
+        connect(&PowerMonitor::self(), &PowerMonitor::lowPowerChanged, this,
+            [this]()
+            {
+                // active state animation already running, or deferred, jumps to its end state
+                if( !animationsEnabled() )
+                {
+                    m_activationTimer->stop();
+                    m_animation->stop();
+                }
+
+                update();
+            }
+        );
+
+        connect(m_captionShaper, &CaptionShaper::shaped, this,
+           [this]()
+           {
+                // caption shaped asynchronously
+                update(titleBar());
+           }
+       );
         connect(c, &KDecoration2::DecoratedClient::captionChanged, this,
            [this]()
            {
                 // update the caption area
                 update(titleBar());
+
+                // match title exceptions again, once the caption settles
+                if( SettingsProvider::snapshot()->hasTitleExceptions ) m_captionTimer->start();
            }
        );
 
         connect(c, &KDecoration2::DecoratedClient::activeChanged, this, &Decoration::updateAnimationState);
+        connect(c, &KDecoration2::DecoratedClient::paletteChanged, this, &Decoration::updateStyleResources);
         connect(c, &KDecoration2::DecoratedClient::widthChanged, this, &Decoration::updateTitleBar);
         connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::updateTitleBar);
         connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::setOpaque);
@@ -221,6 +441,14 @@ namespace SierraBreeze
         connect(c, &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, &Decoration::updateButtonsGeometry);
         connect(c, &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::updateButtonsGeometry);
 
+        // shadow is rendered asynchronously
+        connect(&ImageCache::self(), &ImageCache::imageReady, this,
+            [this]( ImageCache::Key key )
+            {
+                if( key == shadowKey( m_internalSettings ) ) createShadow();
+            }
+        );
+
         createButtons();
         createShadow();
     }
@@ -241,10 +469,50 @@ namespace SierraBreeze
     //________________________________________________________________
     void Decoration::updateAnimationState()
     {
-        if( m_internalSettings->animationsEnabled() )
+        if( animationsEnabled() )
         {
 
             auto c = client().data();
+
+            // hidden windows jump to their final state
+            if( !m_visible )
+            {
+                m_activationTimer->stop();
+                m_animation->stop();
+                setOpacity( c->isActive() ? 1 : 0 );
+                return;
+            }
+
+            // while focus churns, only the window focus settles on is animated
+            switch( FocusChurn::self().transition( c->isActive(), m_animation->duration() ) )
+            {
+                case FocusChurn::Snap:
+                m_activationTimer->stop();
+                m_animation->stop();
+                setOpacity( 0 );
+                update();
+                return;
+
+                case FocusChurn::Defer:
+                m_animation->stop();
+                setOpacity( 0 );
+                m_activationTimer->start( m_animation->duration() );
+                return;
+
+                default:
+                case FocusChurn::Animate:
+                break;
+            }
+
+            // a deferred activation was never shown, there is nothing to fade out
+            if( !c->isActive() && m_activationTimer->isActive() )
+            {
+                m_activationTimer->stop();
+                update();
+                return;
+            }
+
+            m_activationTimer->stop();
             m_animation->setDirection( c->isActive() ? QPropertyAnimation::Forward : QPropertyAnimation::Backward );
             if( m_animation->state() != QPropertyAnimation::Running ) m_animation->start();
 
@@ -255,14 +523,6 @@ namespace SierraBreeze
         }
     }
 
-    //________________________________________________________________
-    void Decoration::updateSizeGripVisibility()
-    {
-        auto c = client().data();
-        if( m_sizeGrip )
-        { m_sizeGrip->setVisible( c->isResizeable() && !isMaximized() && !c->isShaded() ); }
-    }
-
     //________________________________________________________________
     int Decoration::borderSize(bool bottom) const
     {
@@ -304,92 +564,138 @@ namespace SierraBreeze
     //________________________________________________________________
     void Decoration::readKonsoleProfileColor()
     {
-        m_KonsoleTitleBarColorValid = false;
+        // konsole profile is parsed once by the settings provider
+        const auto& colors( SettingsProvider::self()->konsoleColors() );
+        m_KonsoleTitleBarColor = colors.titleBarColor;
+        m_KonsoleTitleBarTextColorActive = colors.textColorActive;
+        m_KonsoleTitleBarTextColorInactive = colors.textColorInactive;
+        m_KonsoleTitleBarColorValid = colors.valid;
+    }
 
-        const KConfig konsoleConfig("konsolerc");
-        const QString defaultProfileFile = konsoleConfig.group("Desktop Entry").readEntry("DefaultProfile", QString());
+    //________________________________________________________________
+    bool Decoration::isKonsoleWindow() const
+    { return m_KonsoleTitleBarColorValid && m_isKonsoleWindow; }
+
+    //________________________________________________________________
+    void Decoration::updateWindowProperties( WId window, WindowPropertyCache::Properties properties )
+    {
 
-        // Konsole config profile path
-        const QString configLocation(QDir::homePath() + "/.local/share/konsole/");
-        const QString shellProfileLocation(configLocation + defaultProfileFile);
+        // only class and role are used by exceptions
+        if( window != m_windowId || !( properties & ( WindowPropertyCache::WindowClass|WindowPropertyCache::WindowRole ) ) ) return;
 
-        if (!QFile::exists(shellProfileLocation)) {
-            return;
+        SettingsChanges changes( ExceptionsChanged );
+        const bool konsoleWindow( isKonsoleMainWindow( WindowPropertyCache::self().entry( m_windowId ) ) );
+        if( konsoleWindow != m_isKonsoleWindow )
+        {
+            m_isKonsoleWindow = konsoleWindow;
+            changes |= KonsoleChanged;
         }
 
-        const KConfig configProfile(shellProfileLocation, KConfig::NoGlobals);
+        updateSettings( changes );
 
-        const QString colorFileLocation = configLocation + configProfile.group("Appearance").readEntry("ColorScheme", QString()) + ".colorscheme";
+    }
 
-        if (!QFile::exists(colorFileLocation)) {
-            return;
-        }
+    //________________________________________________________________
+    void Decoration::reconfigure()
+    {
 
-        const KConfig configColor(colorFileLocation, KConfig::NoGlobals);
-        const QStringList backgroundRGB = configColor.group("Background").readEntry("Color").split(',');
+        m_match = SettingsProvider::self()->match( this );
+        m_internalSettings = m_match.settings;
+        applySettings( AllChanges );
 
-        if (backgroundRGB.size() != 3) {
+    }
+
+    //________________________________________________________________
+    void Decoration::updateSettings( SettingsChanges changes )
+    {
+
+        // hidden windows collect changes, and apply them once when shown again
+        if( !m_visible )
+        {
+            m_deferredChanges |= changes;
             return;
         }
 
-        m_KonsoleTitleBarColor.setRed(backgroundRGB[0].toInt());
-        m_KonsoleTitleBarColor.setGreen(backgroundRGB[1].toInt());
-        m_KonsoleTitleBarColor.setBlue(backgroundRGB[2].toInt());
+        // resolve settings again, and only keep the changes that affect this decoration
+        m_match = SettingsProvider::self()->match( this );
+        changes = ( changes & KonsoleChanged ) | SettingsProvider::compare( m_internalSettings, m_match.settings );
+        m_internalSettings = m_match.settings;
+
+        if( changes ) applySettings( changes );
 
-        m_KonsoleTitleBarColor.setAlpha(configColor.group("General").readEntry("Opacity").toFloat() * 255);
+    }
 
-        // Text color
-        const QStringList foregroundRGB = configColor.group("Foreground").readEntry("Color").split(',');
+    //________________________________________________________________
+    void Decoration::updateTitleSettings()
+    {
 
-        if (foregroundRGB.size() != 3) {
+        // hidden windows match all exceptions again when shown
+        if( !m_visible )
+        {
+            m_deferredChanges |= ExceptionsChanged;
             return;
         }
 
-        m_KonsoleTitleBarTextColorActive.setRed(foregroundRGB[0].toInt());
-        m_KonsoleTitleBarTextColorActive.setGreen(foregroundRGB[1].toInt());
-        m_KonsoleTitleBarTextColorActive.setBlue(foregroundRGB[2].toInt());
+        m_match = SettingsProvider::self()->matchTitle( this, m_match );
+        if( m_match.settings == m_internalSettings ) return;
 
-        m_KonsoleTitleBarTextColorInactive = m_KonsoleTitleBarTextColorActive;
-        m_KonsoleTitleBarTextColorInactive.setAlphaF(0.5);
+        const SettingsChanges changes( SettingsProvider::compare( m_internalSettings, m_match.settings ) );
+        m_internalSettings = m_match.settings;
+
+        if( changes ) applySettings( changes );
 
-        m_KonsoleTitleBarColorValid = true;
     }
 
     //________________________________________________________________
-    bool Decoration::isKonsoleWindow(KDecoration2::DecoratedClient *dc) const
+    void Decoration::updateVisibility()
     {
-        if (!m_KonsoleTitleBarColorValid) {
-          return false;
-        }
 
-        KWindowInfo info(dc->windowId(), 0, NET::WM2WindowClass | NET::WM2WindowRole);
+        const bool visible( VisibilityTracker::isVisible( this ) );
+        if( visible == m_visible ) return;
+        m_visible = visible;
+
+        if( !visible )
+        {
+
+            // finish running animations right away
+            if( isTransitioning() )
+            { updateAnimationState(); }
+
+        } else if( m_deferredChanges ) {
+
+            const SettingsChanges changes( m_deferredChanges );
+            m_deferredChanges = NoChanges;
+            updateSettings( changes );
+
+        }
 
-        return info.valid() &&
-          info.windowClassClass() == QByteArray("konsole") &&
-          info.windowRole().startsWith("MainWindow");
     }
 
     //________________________________________________________________
-    void Decoration::reconfigure()
+    void Decoration::applySettings( SettingsChanges changes )
     {
 
-        m_internalSettings = SettingsProvider::self()->internalSettings( this );
-
         // animation
-        m_animation->setDuration( m_internalSettings->animationsDuration() );
+        if( changes & AnimationsChanged )
+        { m_animation->setDuration( m_internalSettings->animationsDuration() ); }
 
-        // borders
-        recalculateBorders();
+        // konsole title bar color and transparency
+        if( changes & KonsoleChanged )
+        {
+            readKonsoleProfileColor();
+            updateStyleResources();
+        }
+
+        // borders, including the size grip area
+        if( changes & ( BordersChanged|SizeGripChanged ) ) recalculateBorders();
 
         // shadow
-        createShadow();
+        if( changes & ShadowChanged ) createShadow();
 
-        // konsole title bar color and transparency
-        readKonsoleProfileColor();
+        // buttons, or plain repaint
+        if( m_leftButtons && ( changes & ( BordersChanged|ButtonsChanged ) ) ) updateButtonsGeometryDelayed();
+        else if( changes & ( AppearanceChanged|KonsoleChanged ) ) update();
 
-        // size grip
-        if( hasNoBorders() && m_internalSettings->drawSizeGrip() ) createSizeGrip();
-        else deleteSizeGrip();
     }
 
     //________________________________________________________________
@@ -401,7 +707,7 @@ namespace SierraBreeze
         // left, right and bottom borders
         const int left   = isLeftEdge() ? 0 : borderSize();
         const int right  = isRightEdge() ? 0 : borderSize();
-        const int bottom = (c->isShaded() || isBottomEdge()) ? 0 : borderSize(true);
+        int bottom = (c->isShaded() || isBottomEdge()) ? 0 : borderSize(true);
 
         int top = 0;
         if( hideTitleBar() ) top = bottom;
@@ -420,6 +726,13 @@ namespace SierraBreeze
 
         }
 
+        /*
+        size grip. Windows without borders get a bottom border the height of the grip,
+        painted in the bottom right corner only. KDecoration2 maps that corner to BottomRightSection,
+        so that resizing from there is handled by the compositor, both on X11 and wayland
+        */
+        if( hasSizeGrip() ) bottom = sizeGripSize();
+
         setBorders(QMargins(left, top, right, bottom));
 
         // extended sizes
@@ -450,11 +763,22 @@ void Decoration::createButtons()
 
     //________________________________________________________________
     void Decoration::updateButtonsGeometryDelayed()
-    { QTimer::singleShot( 0, this, &Decoration::updateButtonsGeometry ); }
+    {
+        // already scheduled
+        if( m_buttonsGeometryDirty )
+        {
+            Stats::self().increment( Stats::CoalescedButtonLayouts );
+            return;
+        }
+
+        m_buttonsGeometryDirty = true;
+        QTimer::singleShot( 0, this, [this]() { if( m_buttonsGeometryDirty ) updateButtonsGeometry(); } );
+    }
 
     //________________________________________________________________
     void Decoration::updateButtonsGeometry()
     {
+        m_buttonsGeometryDirty = false;
         const auto s = settings();
 
         // adjust button position
@@ -528,6 +852,10 @@ void Decoration::createButtons()
     //________________________________________________________________
     void Decoration::paint(QPainter *painter, const QRect &repaintRegion)
     {
+        // paint time, for adaptive quality
+        QElapsedTimer timer;
+        timer.start();
+
         // TODO: optimize based on repaintRegion
         auto c = client().data();
         auto s = settings();
@@ -537,18 +865,21 @@ void Decoration::createButtons()
         {
             painter->fillRect(rect(), Qt::transparent);
             painter->save();
-            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setRenderHint(QPainter::Antialiasing, !Stats::self().reducedQuality() );
             painter->setPen(Qt::NoPen);
 
-            if ( isKonsoleWindow(c) ) {
+            if ( isKonsoleWindow() ) {
                 painter->setBrush( m_KonsoleTitleBarColor );
             } else {
-                painter->setBrush( c->color( c->isActive() ? ColorGroup::Active : ColorGroup::Inactive, ColorRole::Frame ) );
+                painter->setBrush( m_resources->frameBrush( c->isActive() ) );
             }
 
             // clip away the top part
             if( !hideTitleBar() ) painter->setClipRect(0, borderTop(), size().width(), size().height() - borderTop(), Qt::IntersectClip);
 
+            // the size grip border stays transparent, except for the grip itself
+            if( hasSizeGrip() && s->isAlphaChannelSupported() ) painter->setClipRect(0, 0, size().width(), size().height() - borderBottom(), Qt::IntersectClip);
+
             if( s->isAlphaChannelSupported() ) painter->drawRoundedRect(rect(), Metrics::Frame_FrameRadius, Metrics::Frame_FrameRadius);
             else painter->drawRect( rect() );
 
@@ -557,19 +888,44 @@ void Decoration::createButtons()
 
         if( !hideTitleBar() ) paintTitleBar(painter, repaintRegion);
 
+        if( hasSizeGrip() ) paintSizeGrip(painter, repaintRegion);
+
         if( hasBorders() && !s->isAlphaChannelSupported() )
         {
             painter->save();
             painter->setRenderHint(QPainter::Antialiasing, false);
             painter->setBrush( Qt::NoBrush );
-            painter->setPen( c->isActive() ?
-                c->color( ColorGroup::Active, ColorRole::TitleBar ):
-                c->color( ColorGroup::Inactive, ColorRole::Foreground ) );
+            painter->setPen( m_resources->borderPen( c->isActive() ) );
 
             painter->drawRect( rect().adjusted( 0, 0, -1, -1 ) );
             painter->restore();
         }
 
+        Stats::self().addPaintTime( timer.nsecsElapsed(), m_internalSettings->frameBudget() );
+
+    }
+
+    //________________________________________________________________
+    void Decoration::paintSizeGrip(QPainter *painter, const QRect &repaintRegion)
+    {
+
+        // triangle in the bottom right corner, as high as the bottom border
+        const int gripSize( borderBottom() );
+        const QRect gripRect( size().width() - gripSize, size().height() - gripSize, gripSize, gripSize );
+        if( !gripRect.intersects( repaintRegion ) ) return;
+
+        QPolygon polygon;
+        polygon << gripRect.bottomLeft() + QPoint( 0, 1 )
+            << gripRect.topRight() + QPoint( 1, 0 )
+            << gripRect.bottomRight() + QPoint( 1, 1 );
+
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing, !Stats::self().reducedQuality() );
+        painter->setPen( Qt::NoPen );
+        painter->setBrush( titleBarColor() );
+        painter->drawPolygon( polygon );
+        painter->restore();
+
     }
 
     //________________________________________________________________
@@ -577,7 +933,7 @@ void Decoration::createButtons()
     {
         const auto c = client().data();
         // TODO Review this. Here the window color is appended in matchedTitleBarColor var
-        const QColor matchedTitleBarColor(c->palette().color(QPalette::Window));
+        const QColor matchedTitleBarColor( m_resources->windowColor() );
         const QRect titleRect(QPoint(0, 0), QSize(size().width(), borderTop()));
 
         if ( !titleRect.intersects(repaintRegion) ) return;
@@ -586,17 +942,14 @@ void Decoration::createButtons()
         painter->setPen(Qt::NoPen);
 
         // render a linear gradient on title area
-        if ( c->isActive() && m_internalSettings->drawBackgroundGradient() && !isKonsoleWindow(c) )
+        if ( c->isActive() && m_internalSettings->drawBackgroundGradient() && !Stats::self().reducedQuality() && !lowPowerMode() && !isKonsoleWindow() )
         {
 
             // TODO Review this. Initialize titleBarColor based on user's choise.
             const QColor titleBarColor = (matchColorForTitleBar()  ? matchedTitleBarColor : this->titleBarColor() );
-            QLinearGradient gradient( 0, 0, 0, titleRect.height() );
-            gradient.setColorAt(0.0, titleBarColor.lighter( 120 ) );
-            gradient.setColorAt(0.8, titleBarColor);
-            painter->setBrush(gradient);
+            painter->setBrush( gradientBrush( titleRect.height(), titleBarColor, painter->device()->devicePixelRatioF() ) );
 
-        } else if ( !isKonsoleWindow(c) ) {
+        } else if ( !isKonsoleWindow() ) {
 
             // TODO Review this. Initialize titleBarColor based on user's choise.
             // I needed another else if because the window might not be active or has drawBackgroundGradient but
@@ -648,12 +1001,8 @@ void Decoration::createButtons()
         painter->restore();
 
         // draw caption
-        painter->setFont(s->font());
-        painter->setPen( fontColor() );
-
         const auto cR = captionRect();
-        const QString caption = painter->fontMetrics().elidedText(c->caption(), Qt::ElideMiddle, cR.first.width());
-        painter->drawText(cR.first, cR.second | Qt::TextSingleLine, caption);
+        m_captionCache.paint( painter, m_captionShaper->layout().elided, s->font(), cR.first, cR.second, fontColor() );
 
         // draw all buttons
         m_leftButtons->paint(painter, repaintRegion);
@@ -691,6 +1040,9 @@ void Decoration::createButtons()
             const int yOffset = settings()->smallSpacing()*Metrics::TitleBar_TopMargin;
             const QRect maxRect( leftOffset, yOffset, size().width() - leftOffset - rightOffset, captionHeight() );
 
+            // shape caption for the available width. Long captions are shaped asynchronously
+            const auto& layout = m_captionShaper->layout( c->caption(), settings()->font(), maxRect.width() );
+
             switch( m_internalSettings->titleAlignment() )
             {
                 case InternalSettings::AlignLeft:
@@ -708,7 +1060,8 @@ void Decoration::createButtons()
 
                     // full caption rect
                     const QRect fullRect = QRect( 0, yOffset, size().width(), captionHeight() );
-                    QRect boundingRect( settings()->fontMetrics().boundingRect( c->caption()).toRect() );
+                    // caption width is taken from the shaped caption, possibly the previous one
+                    QRect boundingRect( 0, 0, qCeil( layout.naturalWidth ), captionHeight() );
 
                     // text bounding rect
                     boundingRect.setTop( yOffset );
@@ -728,82 +1081,56 @@ void Decoration::createButtons()
     }
 
     //________________________________________________________________
-    void Decoration::createShadow()
+    void Decoration::warmUp()
     {
 
-        // assign global shadow if exists and parameters match
-        if(
-            !g_sShadow  ||
-            g_shadowSize != m_internalSettings->shadowSize() ||
-            g_shadowStrength != m_internalSettings->shadowStrength() ||
-            g_shadowColor != m_internalSettings->shadowColor()
-            )
-        {
-            // assign parameters
-            g_shadowSize = m_internalSettings->shadowSize();
-            g_shadowStrength = m_internalSettings->shadowStrength();
-            g_shadowColor = m_internalSettings->shadowColor();
-            const int shadowOffset = qMax( 6*g_shadowSize/16, Metrics::Shadow_Overlap*2 );
-
-            // create image
-            QImage image(2*g_shadowSize, 2*g_shadowSize, QImage::Format_ARGB32_Premultiplied);
-            image.fill(Qt::transparent);
-
-            // create gradient
-            // gaussian delta function
-            auto alpha = [](qreal x) { return std::exp( -x*x/0.15 ); };
-
-            // color calculation delta function
-            auto gradientStopColor = [](QColor color, int alpha)
+        // settings, compiled exceptions and konsole colors
+        auto watcher( new QFutureWatcher<SettingsProvider::Prefetch>( &ImageCache::self() ) );
+        connect( watcher, &QFutureWatcherBase::finished, watcher, [watcher]()
             {
-                color.setAlpha(alpha);
-                return color;
-            };
+                // the provider builds the first snapshot from the prefetched data, in the gui thread
+                SettingsProvider::self();
 
-            QRadialGradient radialGradient( g_shadowSize, g_shadowSize, g_shadowSize );
-            for( int i = 0; i < 10; ++i )
-            {
-                const qreal x( qreal( i )/9 );
-                radialGradient.setColorAt(x,  gradientStopColor( g_shadowColor, alpha(x)*g_shadowStrength ) );
-            }
+                // default shadow and button art, once their settings are known
+                const InternalSettingsPtr defaultSettings( SettingsProvider::snapshot()->defaultSettings );
+                shadowImage( defaultSettings );
+                Button::warmUp( defaultSettings );
+                watcher->deleteLater();
+            } );
 
-            radialGradient.setColorAt(1, gradientStopColor( g_shadowColor, 0 ) );
+        watcher->setFuture( SettingsProvider::warmUp() );
 
-            // fill
-            painter.begin(&image);
-            //TODO review these
-            //QPainter painter(&image);
-            painter.setRenderHint( QPainter::Antialiasing, true );
-            painter.fillRect( image.rect(), radialGradient);
+        // atoms used by the window property cache, read back when the first decoration is created
+        WindowPropertyCache::warmUp();
 
-            // contrast pixel
-            QRectF innerRect = QRectF(
-                g_shadowSize - Metrics::Shadow_Overlap, g_shadowSize - shadowOffset - Metrics::Shadow_Overlap,
-                2*Metrics::Shadow_Overlap, shadowOffset + 2*Metrics::Shadow_Overlap );
-                // g_shadowSize - shadowOffset - Metrics::Shadow_Overlap, g_shadowSize - shadowOffset - Metrics::Shadow_Overlap,
-                // shadowOffset + 2*Metrics::Shadow_Overlap, shadowOffset + 2*Metrics::Shadow_Overlap );
+    }
 
-            painter.setPen( gradientStopColor( g_shadowColor, g_shadowStrength*0.5 ) );
-            painter.setBrush( Qt::NoBrush );
-            painter.drawRoundedRect( innerRect, -0.5 + Metrics::Frame_FrameRadius, -0.5 + Metrics::Frame_FrameRadius );
+    //________________________________________________________________
+    void Decoration::createShadow()
+    {
 
-            // mask out inner rect
-            painter.setPen( Qt::NoPen );
-            painter.setBrush( Qt::black );
-            painter.setCompositionMode(QPainter::CompositionMode_DestinationOut );
-            painter.drawRoundedRect( innerRect, 0.5 + Metrics::Frame_FrameRadius, 0.5 + Metrics::Frame_FrameRadius );
+        // assign global shadow if exists and parameters match
+        const ImageCache::Key key( shadowKey( m_internalSettings ) );
+        if( !g_sShadow || g_shadowKey != key )
+        {
 
-            painter.end();
+            // keep the current shadow until the new image is ready
+            const QImage image( shadowImage( m_internalSettings ) );
+            if( image.isNull() ) return;
+
+            // assign parameters
+            g_shadowKey = key;
+            const int shadowSize = m_internalSettings->shadowSize();
+            const int shadowOffset = qMax( 6*shadowSize/16, Metrics::Shadow_Overlap*2 );
 
             g_sShadow = QSharedPointer<KDecoration2::DecorationShadow>::create();
             g_sShadow->setPadding( QMargins(
-                // g_shadowSize - shadowOffset - Metrics::Shadow_Overlap,
-                g_shadowSize - Metrics::Shadow_Overlap,
-                g_shadowSize - shadowOffset - Metrics::Shadow_Overlap,
-                g_shadowSize - Metrics::Shadow_Overlap,
-                g_shadowSize - Metrics::Shadow_Overlap ) );
+                shadowSize - Metrics::Shadow_Overlap,
+                shadowSize - shadowOffset - Metrics::Shadow_Overlap,
+                shadowSize - Metrics::Shadow_Overlap,
+                shadowSize - Metrics::Shadow_Overlap ) );
 
-            g_sShadow->setInnerShadowRect(QRect( g_shadowSize, g_shadowSize, 1, 1) );
+            g_sShadow->setInnerShadowRect(QRect( shadowSize, shadowSize, 1, 1) );
 
             // assign image
             g_sShadow->setShadow(image);
@@ -814,41 +1141,6 @@ void Decoration::createButtons()
 
     }
 
-    //_________________________________________________________________
-    void Decoration::createSizeGrip( void )
-    {
-
-        // do nothing if size grip already exist
-        if( m_sizeGrip ) return;
-
-        #if BREEZE_HAVE_X11
-        if( !QX11Info::isPlatformX11() ) return;
-
-        // access client
-        auto c = client().data();
-        if( !c ) return;
-
-        if( c->windowId() != 0 )
-        {
-            m_sizeGrip = new SizeGrip( this );
-            connect( c, &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::updateSizeGripVisibility );
-            connect( c, &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::updateSizeGripVisibility );
-            connect( c, &KDecoration2::DecoratedClient::resizeableChanged, this, &Decoration::updateSizeGripVisibility );
-        }
-        #endif
-
-    }
-
-    //_________________________________________________________________
-    void Decoration::deleteSizeGrip( void )
-    {
-        if( m_sizeGrip )
-        {
-            m_sizeGrip->deleteLater();
-            m_sizeGrip = nullptr;
-        }
-    }
-
 } // namespace
 
 
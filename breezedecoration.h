@@ -23,7 +23,12 @@
  */
 
 #include "breeze.h"
+#include "breezecaptioncache.h"
+#include "breezecolortransition.h"
 #include "breezesettings.h"
+#include "breezesettingsprovider.h"
+#include "breezestyleresources.h"
+#include "breezewindowpropertycache.h"
 
 #include <KDecoration2/Decoration>
 #include <KDecoration2/DecoratedClient>
@@ -33,6 +38,7 @@
 #include <QPropertyAnimation>
 #include <QVariant>
 #include <QPainter>
+#include <QTimer>
 
 namespace KDecoration2
 {
@@ -42,7 +48,7 @@ namespace KDecoration2
 
 namespace SierraBreeze
 {
-    class SizeGrip;
+    class CaptionShaper;
     class Decoration : public KDecoration2::Decoration
     {
         Q_OBJECT
@@ -61,6 +67,9 @@ namespace SierraBreeze
         //* paint
         void paint(QPainter *painter, const QRect &repaintRegion) override;
 
+        //* prepare settings, shadow and button art ahead of the first decoration
+        static void warmUp( void );
+
         //* internal settings
         InternalSettingsPtr internalSettings() const
         { return m_internalSettings; }
@@ -78,10 +87,25 @@ namespace SierraBreeze
         qreal opacity( void ) const
         { return m_opacity; }
 
+        bool isAnimating( void ) const
+        { return m_animation->state() == QPropertyAnimation::Running; }
+
+        //* true while animating, or while a deferred activation waits in the inactive state
+        bool isTransitioning( void ) const;
+
+        //* true if animations are enabled, quality is not reduced and not in low power mode
+        bool animationsEnabled( void ) const;
+
+        //* true when forced in settings, or when following a low power system state
+        bool lowPowerMode( void ) const;
+
         //@}
 
         //*@name colors
         //@{
+        const StyleResources& styleResources( void ) const
+        { return *m_resources; }
+
         QColor titleBarColor( void ) const;
         QColor outlineColor( void ) const;
         QColor fontColor( void ) const;
@@ -102,27 +126,35 @@ namespace SierraBreeze
         inline bool matchColorForTitleBar( void ) const;
         //@}
 
+        //* check whether window is minimized or on another desktop
+        void updateVisibility( void );
+
         public Q_SLOTS:
         void init() override;
 
         private Q_SLOTS:
         void reconfigure();
+        void updateSettings( SettingsChanges );
+        void updateTitleSettings();
         void recalculateBorders();
         void updateButtonsGeometry();
         void updateButtonsGeometryDelayed();
         void updateTitleBar();
         void updateAnimationState();
-        void updateSizeGripVisibility();
+        void updateStyleResources();
+        void updateWindowProperties( WId, WindowPropertyCache::Properties );
 
         private:
 
         //* return the rect in which caption will be drawn
         QPair<QRect,Qt::Alignment> captionRect( void ) const;
 
+        void applySettings( SettingsChanges );
         void createButtons();
         void paintTitleBar(QPainter *painter, const QRect &repaintRegion);
+        void paintSizeGrip(QPainter *painter, const QRect &repaintRegion);
         void readKonsoleProfileColor();
-        bool isKonsoleWindow(KDecoration2::DecoratedClient *dc) const;
+        bool isKonsoleWindow( void ) const;
         void createShadow();
 
         //*@name border size
@@ -133,12 +165,12 @@ namespace SierraBreeze
         inline bool hasNoSideBorders( void ) const;
         //@}
 
-        //*@name size grip
+        //*@name size grip, painted in the bottom right corner of windows without borders
         //@{
-        void createSizeGrip( void );
-        void deleteSizeGrip( void );
-        SizeGrip* sizeGrip( void ) const
-        { return m_sizeGrip; }
+        inline bool hasSizeGrip( void ) const;
+
+        int sizeGripSize( void ) const
+        { return settings()->smallSpacing()*Metrics::SizeGrip_Size; }
         //@}
 
         InternalSettingsPtr m_internalSettings;
@@ -146,23 +178,52 @@ namespace SierraBreeze
         KDecoration2::DecorationButtonGroup *m_leftButtons = nullptr;
         KDecoration2::DecorationButtonGroup *m_rightButtons = nullptr;
 
-        //* size grip widget
-        SizeGrip *m_sizeGrip = nullptr;
-
         //* active state change animation
         QPropertyAnimation *m_animation;
 
+        //* delays the activation animation while focus changes quickly
+        QTimer *m_activationTimer;
+
+        //* delays matching title exceptions while the caption changes
+        QTimer *m_captionTimer;
+
+        //* matched exception, for the current snapshot
+        SettingsProvider::Match m_match;
+
+        //* window id, for visibility tracking
+        WId m_windowId = 0;
+
+        //* true when button geometry must be updated on the next event loop turn
+        bool m_buttonsGeometryDirty = false;
+
+        //* false when window is minimized or on another desktop
+        bool m_visible = true;
+
+        //* settings changes received while hidden
+        SettingsChanges m_deferredChanges;
+
         //* active state change opacity
         qreal m_opacity = 0;
 
+        //* colors, pens and brushes for the client palette
+        StyleResourcesPtr m_resources;
+
+        //* konsole font color active state change
+        ColorTransition m_konsoleFontTransition;
+
+        //* shaped caption
+        CaptionShaper *m_captionShaper;
+
+        //* rendered caption
+        CaptionCache m_captionCache;
+
         QColor m_KonsoleTitleBarColor;
         QColor m_KonsoleTitleBarTextColorActive;
         QColor m_KonsoleTitleBarTextColorInactive;
         bool m_KonsoleTitleBarColorValid;
 
-        //TODO Review this
-        QPainter painter;
-        const QRect repaintRegion;
+        //* konsole main window, from cached window class and role
+        bool m_isKonsoleWindow = false;
 
     };
 
@@ -184,6 +245,12 @@ namespace SierraBreeze
         else return settings()->borderSize() == KDecoration2::BorderSize::NoSides;
     }
 
+    bool Decoration::hasSizeGrip( void ) const
+    {
+        auto c = client().data();
+        return hasNoBorders() && m_internalSettings->drawSizeGrip() && c->isResizeable() && !isMaximized() && !c->isShaded();
+    }
+
     bool Decoration::isMaximized( void ) const
     { return client().data()->isMaximized() && !m_internalSettings->drawBorderOnMaximizedWindows(); }
 
@@ -41,19 +41,20 @@ namespace SierraBreeze
         {
 
             // create exception
-            InternalSettings exception;
+            InternalSettings exception( config );
 
             // reset group
             readConfig( &exception, config.data(), groupName );
 
             // create new configuration
-            InternalSettingsPtr configuration( new InternalSettings() );
-            configuration.data()->load();
+            InternalSettingsPtr configuration( new InternalSettings( config ) );
+            configuration.data()->read();
 
             // apply changes from exception
             configuration->setEnabled( exception.enabled() );
             configuration->setExceptionType( exception.exceptionType() );
             configuration->setExceptionPattern( exception.exceptionPattern() );
+            configuration->setExceptionPatternKind( exception.exceptionPatternKind() );
             configuration->setMask( exception.mask() );
 
             // propagate all features found in mask to the output configuration
@@ -97,7 +98,7 @@ namespace SierraBreeze
     {
 
         // list of items to be written
-        QStringList keys = { "Enabled", "ExceptionPattern", "ExceptionType", "HideTitleBar", "Mask", "BorderSize"};
+        QStringList keys = { "Enabled", "ExceptionPattern", "ExceptionPatternKind", "ExceptionType", "HideTitleBar", "Mask", "BorderSize"};
 
         // write all items
         foreach( auto key, keys )
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezefocuschurn.h"
+
+namespace SierraBreeze
+{
+
+    //__________________________________________________________________
+    FocusChurn& FocusChurn::self( void )
+    {
+        static FocusChurn churn;
+        return churn;
+    }
+
+    //__________________________________________________________________
+    FocusChurn::FocusChurn( void )
+    {
+        for( auto& activation : m_activations )
+        { activation = -1; }
+    }
+
+    //__________________________________________________________________
+    FocusChurn::Transition FocusChurn::transition( bool activated, int duration )
+    {
+        if( !m_clock.isValid() ) m_clock.start();
+        return transition( activated, duration, m_clock.elapsed() );
+    }
+
+    //__________________________________________________________________
+    FocusChurn::Transition FocusChurn::transition( bool activated, int duration, qint64 now )
+    {
+
+        // record activations only
+        if( activated )
+        {
+            m_activations[m_index] = now;
+            m_index = ( m_index + 1 )%Activations;
+        }
+
+        // churn if the oldest of the last activations is within one animation period
+        const qint64 oldest( m_activations[m_index] );
+        if( !( oldest >= 0 && now - oldest < duration ) ) return Animate;
+
+        /*
+        deactivated windows jump to their final state. Activated windows stay inactive,
+        and only animate once focus has settled on them
+        */
+        return activated ? Defer : Snap;
+
+    }
+
+}
@@ -0,0 +1,83 @@
+#ifndef breezefocuschurn_h
+#define breezefocuschurn_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+namespace SierraBreeze
+{
+
+    /**
+    detects focus churn, when focus moves through several windows within one animation period,
+    as when cycling with alt+tab, and decides how each active state change is shown.
+    A single record of recent activations is shared by all decorations
+    */
+    class FocusChurn
+    {
+
+        public:
+
+        //* how an active state change is shown
+        enum Transition
+        {
+            //* animate, focus is settled
+            Animate,
+
+            //* jump to the final state, with a single repaint
+            Snap,
+
+            //* keep the current state, and animate after one animation period if still active
+            Defer
+        };
+
+        //* number of activations within one animation period that qualifies as churn
+        enum { Activations = 3 };
+
+        //* singleton
+        static FocusChurn& self( void );
+
+        //* constructor
+        FocusChurn( void );
+
+        //* record an active state change happening now, and return how to show it
+        Transition transition( bool activated, int duration );
+
+        //* record an active state change at given time, in ms, and return how to show it
+        Transition transition( bool activated, int duration, qint64 now );
+
+        private:
+
+        //* last activation times, in ms. Negative if unset
+        qint64 m_activations[Activations];
+
+        //* index of the oldest activation
+        int m_index = 0;
+
+        //* clock
+        QElapsedTimer m_clock;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezeimagecache.h"
+
+#include <QCoreApplication>
+#include <QtConcurrentRun>
+
+namespace SierraBreeze
+{
+
+    //__________________________________________________________________
+    ImageCache& ImageCache::self( void )
+    {
+        // allocated once, and never deleted, see shutdown
+        static ImageCache* cache( new ImageCache() );
+        return *cache;
+    }
+
+    //__________________________________________________________________
+    ImageCache::ImageCache( void )
+    {
+        // a couple of threads is enough for shadows and button sprites
+        m_threadPool.setMaxThreadCount( 2 );
+
+        connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &ImageCache::shutdown );
+    }
+
+    //__________________________________________________________________
+    void ImageCache::shutdown( void )
+    {
+        m_threadPool.clear();
+        m_threadPool.waitForDone();
+
+        qDeleteAll( m_pending );
+        m_pending.clear();
+    }
+
+    //__________________________________________________________________
+    QImage ImageCache::image( Key key, const Renderer& renderer )
+    {
+
+        const QImage image( CacheManager::self().image( key ) );
+        if( !image.isNull() ) return image;
+
+        // start rendering, unless already pending
+        if( !m_pending.contains( key ) )
+        {
+            auto watcher( new QFutureWatcher<QImage>( this ) );
+            connect( watcher, &QFutureWatcherBase::finished, this, [this, key, watcher]()
+                {
+                    m_pending.remove( key );
+                    CacheManager::self().insert( key, watcher->result() );
+                    watcher->deleteLater();
+                    emit imageReady( key );
+                } );
+
+            m_pending.insert( key, watcher );
+            watcher->setFuture( QtConcurrent::run( &m_threadPool, renderer ) );
+        }
+
+        return QImage();
+
+    }
+
+}
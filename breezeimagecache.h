@@ -0,0 +1,95 @@
+#ifndef breezeimagecache_h
+#define breezeimagecache_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecachemanager.h"
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QThreadPool>
+
+#include <functional>
+
+namespace SierraBreeze
+{
+
+    /**
+    images rendered asynchronously, on a small pool of worker threads.
+    The cache is never deleted: pending jobs are dropped and the threads are waited for
+    when the application is about to quit
+    */
+    class ImageCache: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* image key
+        using Key = CacheManager::Key;
+
+        //* image renderer. Called from a worker thread
+        using Renderer = std::function<QImage()>;
+
+        //* singleton
+        static ImageCache& self( void );
+
+        /**
+        image matching given key, or a null image if it is not rendered yet.
+        In that case, rendering is started on the worker threads,
+        and imageReady is emitted once the image is available.
+        Rendered images are stored in the cache manager
+        */
+        QImage image( Key, const Renderer& );
+
+        //* worker threads
+        QThreadPool* threadPool( void )
+        { return &m_threadPool; }
+
+        Q_SIGNALS:
+
+        //* emitted in the gui thread when the image for given key is ready
+        void imageReady( ImageCache::Key );
+
+        private Q_SLOTS:
+
+        //* drop pending jobs and wait for the worker threads, before the application goes away
+        void shutdown( void );
+
+        private:
+
+        //* constructor
+        ImageCache( void );
+
+        //* worker threads
+        QThreadPool m_threadPool;
+
+        //* pending jobs
+        QHash<Key, QFutureWatcher<QImage>*> m_pending;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezepowermonitor.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusVariant>
+
+namespace SierraBreeze
+{
+
+    //*@name services
+    //@{
+    static const QString UPowerService = QStringLiteral( "org.freedesktop.UPower" );
+    static const QString UPowerPath = QStringLiteral( "/org/freedesktop/UPower" );
+    static const QString UPowerInterface = QStringLiteral( "org.freedesktop.UPower" );
+
+    static const QString PowerProfilesService = QStringLiteral( "net.hadess.PowerProfiles" );
+    static const QString PowerProfilesPath = QStringLiteral( "/net/hadess/PowerProfiles" );
+    static const QString PowerProfilesInterface = QStringLiteral( "net.hadess.PowerProfiles" );
+
+    static const QString PropertiesInterface = QStringLiteral( "org.freedesktop.DBus.Properties" );
+    //@}
+
+    //__________________________________________________________________
+    PowerMonitor& PowerMonitor::self( void )
+    {
+        // allocated once, and never deleted, see shutdown
+        static PowerMonitor* monitor( new PowerMonitor() );
+        return *monitor;
+    }
+
+    //__________________________________________________________________
+    PowerMonitor::PowerMonitor( void )
+    {
+
+        auto bus( QDBusConnection::systemBus() );
+        bus.connect( UPowerService, UPowerPath, PropertiesInterface, QStringLiteral( "PropertiesChanged" ),
+            this, SLOT(propertiesChanged(QString,QVariantMap,QStringList)) );
+        bus.connect( PowerProfilesService, PowerProfilesPath, PropertiesInterface, QStringLiteral( "PropertiesChanged" ),
+            this, SLOT(propertiesChanged(QString,QVariantMap,QStringList)) );
+
+        // initial state. Missing services leave it at full power
+        readProperty( UPowerService, UPowerPath, UPowerInterface, QStringLiteral( "OnBattery" ) );
+        readProperty( PowerProfilesService, PowerProfilesPath, PowerProfilesInterface, QStringLiteral( "ActiveProfile" ) );
+
+        connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &PowerMonitor::shutdown );
+
+    }
+
+    //__________________________________________________________________
+    void PowerMonitor::shutdown( void )
+    {
+
+        auto bus( QDBusConnection::systemBus() );
+        bus.disconnect( UPowerService, UPowerPath, PropertiesInterface, QStringLiteral( "PropertiesChanged" ),
+            this, SLOT(propertiesChanged(QString,QVariantMap,QStringList)) );
+        bus.disconnect( PowerProfilesService, PowerProfilesPath, PropertiesInterface, QStringLiteral( "PropertiesChanged" ),
+            this, SLOT(propertiesChanged(QString,QVariantMap,QStringList)) );
+
+        // pending replies are dropped
+        qDeleteAll( findChildren<QDBusPendingCallWatcher*>() );
+
+    }
+
+    //__________________________________________________________________
+    void PowerMonitor::readProperty( const QString& service, const QString& path, const QString& interface, const QString& property )
+    {
+
+        auto message( QDBusMessage::createMethodCall( service, path, PropertiesInterface, QStringLiteral( "Get" ) ) );
+        message << interface << property;
+
+        auto watcher( new QDBusPendingCallWatcher( QDBusConnection::systemBus().asyncCall( message ), this ) );
+        connect( watcher, &QDBusPendingCallWatcher::finished, this, [this, interface, property]( QDBusPendingCallWatcher* watcher )
+            {
+                const QDBusPendingReply<QDBusVariant> reply( *watcher );
+                if( !reply.isError() ) updateProperty( interface, property, reply.value().variant() );
+                watcher->deleteLater();
+            } );
+
+    }
+
+    //__________________________________________________________________
+    void PowerMonitor::propertiesChanged( const QString& interface, const QVariantMap& changed, const QStringList& )
+    {
+        for( auto iter = changed.constBegin(); iter != changed.constEnd(); ++iter )
+        { updateProperty( interface, iter.key(), iter.value() ); }
+    }
+
+    //__________________________________________________________________
+    void PowerMonitor::updateProperty( const QString& interface, const QString& property, const QVariant& value )
+    {
+
+        const bool lowPower( isLowPower() );
+
+        if( interface == UPowerInterface && property == QLatin1String( "OnBattery" ) )
+        {
+            m_onBattery = value.toBool();
+        } else if( interface == PowerProfilesInterface && property == QLatin1String( "ActiveProfile" ) ) {
+            m_powerSaver = ( value.toString() == QLatin1String( "power-saver" ) );
+        }
+
+        if( lowPower != isLowPower() ) emit lowPowerChanged( isLowPower() );
+
+    }
+
+}
@@ -0,0 +1,84 @@
+#ifndef breezepowermonitor_h
+#define breezepowermonitor_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QStringList>
+#include <QVariantMap>
+
+namespace SierraBreeze
+{
+
+    /**
+    follows the system power state over D-Bus:
+    UPower for battery, and power-profiles-daemon for the power saver profile.
+    The monitor is never deleted: it stops listening to the system bus when the application is about to quit
+    */
+    class PowerMonitor: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* singleton
+        static PowerMonitor& self( void );
+
+        //* true when on battery, or in the power saver profile
+        bool isLowPower( void ) const
+        { return m_onBattery || m_powerSaver; }
+
+        Q_SIGNALS:
+
+        //* emitted when low power state changes
+        void lowPowerChanged( bool );
+
+        private Q_SLOTS:
+
+        //* properties changed on one of the services
+        void propertiesChanged( const QString& interface, const QVariantMap& changed, const QStringList& invalidated );
+
+        //* disconnect from the system bus, before the application goes away
+        void shutdown( void );
+
+        private:
+
+        //* constructor
+        PowerMonitor( void );
+
+        //* read property asynchronously
+        void readProperty( const QString& service, const QString& path, const QString& interface, const QString& property );
+
+        //* update state from property value
+        void updateProperty( const QString& interface, const QString& property, const QVariant& value );
+
+        //* true when on battery
+        bool m_onBattery = false;
+
+        //* true in power saver profile
+        bool m_powerSaver = false;
+
+    };
+
+}
+
+#endif
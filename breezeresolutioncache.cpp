@@ -0,0 +1,218 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezeresolutioncache.h"
+#include "breezeimagecache.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrentRun>
+
+namespace SierraBreeze
+{
+
+    //* file format
+    static const quint32 CacheMagic = 0x53425243;
+    static const quint32 CacheVersion = 1;
+
+    //* delay before writing changes to disk (ms)
+    static const int SaveDelay = 2000;
+
+    //* maximum number of window classes kept
+    static const int MaxEntries = 512;
+
+    //__________________________________________________________________
+    ResolutionCache& ResolutionCache::self( void )
+    {
+        // allocated once, and never deleted, see shutdown
+        static ResolutionCache* cache( new ResolutionCache() );
+        return *cache;
+    }
+
+    //__________________________________________________________________
+    ResolutionCache::ResolutionCache( void )
+    {
+        m_saveTimer.setSingleShot( true );
+        m_saveTimer.setInterval( SaveDelay );
+        connect( &m_saveTimer, &QTimer::timeout, this, &ResolutionCache::save );
+        connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &ResolutionCache::shutdown );
+    }
+
+    //__________________________________________________________________
+    void ResolutionCache::shutdown( void )
+    {
+        // verifications still running are not waited for, their result would only be used by this session
+        if( !m_saveTimer.isActive() ) return;
+        m_saveTimer.stop();
+        save();
+    }
+
+    //__________________________________________________________________
+    QString ResolutionCache::fileName( void )
+    { return QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation ) + QStringLiteral( "/sierrabreeze/classmatches" ); }
+
+    //__________________________________________________________________
+    QByteArray ResolutionCache::configHash( void )
+    {
+
+        // hash is computed once per change of the file, as told by its modification time and size
+        static QMutex mutex;
+        static qint64 modified = -1;
+        static qint64 size = -1;
+        static QByteArray hash;
+
+        const QFileInfo info( QStandardPaths::locate( QStandardPaths::GenericConfigLocation, QStringLiteral( "breezerc" ) ) );
+        if( !info.exists() ) return QByteArray();
+
+        QMutexLocker locker( &mutex );
+        if( info.lastModified().toMSecsSinceEpoch() == modified && info.size() == size ) return hash;
+
+        QFile file( info.filePath() );
+        if( !file.open( QIODevice::ReadOnly ) ) return QByteArray();
+
+        modified = info.lastModified().toMSecsSinceEpoch();
+        size = info.size();
+        hash = QCryptographicHash::hash( file.readAll(), QCryptographicHash::Sha1 );
+        return hash;
+
+    }
+
+    //__________________________________________________________________
+    QHash<QString, int> ResolutionCache::read( const QByteArray& configHash )
+    {
+
+        QHash<QString, int> matches;
+
+        QFile file( fileName() );
+        if( configHash.isEmpty() || !file.open( QIODevice::ReadOnly ) ) return matches;
+
+        QDataStream stream( &file );
+        stream.setVersion( QDataStream::Qt_5_6 );
+
+        quint32 magic = 0;
+        quint32 version = 0;
+        QByteArray hash;
+        stream >> magic >> version;
+        if( magic != CacheMagic || version != CacheVersion ) return matches;
+
+        // matches built against another configuration are discarded
+        stream >> hash;
+        if( hash != configHash ) return matches;
+
+        stream >> matches;
+        if( stream.status() != QDataStream::Ok ) matches.clear();
+        return matches;
+
+    }
+
+    //__________________________________________________________________
+    void ResolutionCache::reset( const QByteArray& configHash, const QHash<QString, int>& matches )
+    {
+        m_configHash = configHash;
+        m_matches = matches;
+        m_verified.clear();
+        m_saveTimer.stop();
+    }
+
+    //__________________________________________________________________
+    void ResolutionCache::insert( const QString& windowClass, int classIndex )
+    {
+        if( m_configHash.isEmpty() ) return;
+
+        auto iter( m_matches.find( windowClass ) );
+        if( iter != m_matches.end() && iter.value() == classIndex ) return;
+
+        m_matches.insert( windowClass, classIndex );
+        m_verified.insert( windowClass );
+        m_saveTimer.start();
+    }
+
+    //__________________________________________________________________
+    void ResolutionCache::verify( const QString& windowClass, SettingsProvider::SnapshotPtr snapshot )
+    {
+
+        if( m_verified.contains( windowClass ) ) return;
+        m_verified.insert( windowClass );
+
+        auto watcher = new QFutureWatcher<int>( this );
+        connect( watcher, &QFutureWatcher<int>::finished, this, [this, watcher, windowClass, snapshot]()
+            {
+                watcher->deleteLater();
+
+                // configuration changed in the meantime
+                if( snapshot != SettingsProvider::snapshot() ) return;
+
+                const int classIndex( watcher->result() );
+                if( classIndex == this->classIndex( windowClass ) ) return;
+
+                insert( windowClass, classIndex );
+                emit corrected( windowClass );
+            } );
+
+        watcher->setFuture( QtConcurrent::run( ImageCache::self().threadPool(),
+            [windowClass, snapshot]() { return SettingsProvider::classMatch( snapshot, windowClass ); } ) );
+
+    }
+
+    //__________________________________________________________________
+    void ResolutionCache::save( void )
+    {
+
+        // keep the file bounded. Classes seen in this session go first, stale ones fill what is left
+        if( m_matches.size() > MaxEntries )
+        {
+            QHash<QString, int> matches;
+            for( const QString& windowClass : m_verified )
+            {
+                auto iter( m_matches.constFind( windowClass ) );
+                if( iter != m_matches.constEnd() ) matches.insert( iter.key(), iter.value() );
+                if( matches.size() == MaxEntries ) break;
+            }
+
+            for( auto iter = m_matches.constBegin(); iter != m_matches.constEnd() && matches.size() < MaxEntries; ++iter )
+            { matches.insert( iter.key(), iter.value() ); }
+
+            m_matches = matches;
+        }
+
+        const QString fileName( ResolutionCache::fileName() );
+        QDir().mkpath( QFileInfo( fileName ).absolutePath() );
+
+        QSaveFile file( fileName );
+        if( !file.open( QIODevice::WriteOnly ) ) return;
+
+        QDataStream stream( &file );
+        stream.setVersion( QDataStream::Qt_5_6 );
+        stream << CacheMagic << CacheVersion << m_configHash << m_matches;
+        file.commit();
+
+    }
+
+}
@@ -0,0 +1,109 @@
+#ifndef breezeresolutioncache_h
+#define breezeresolutioncache_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezesettingsprovider.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+namespace SierraBreeze
+{
+
+    /**
+    persistent window class to exception match cache.
+    Stored in the user cache directory, and only valid for the breezerc it was built against,
+    so that restored windows can skip class exception matching. Cached matches are used right away,
+    and verified on the worker threads. The cache is never deleted: pending changes are written
+    when the application is about to quit
+    */
+    class ResolutionCache: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* singleton
+        static ResolutionCache& self( void );
+
+        //* read class matches stored for given configuration hash. Safe to call from any thread
+        static QHash<QString, int> read( const QByteArray& configHash );
+
+        //* hash of the configuration file, computed again only when the file changed. Safe to call from any thread
+        static QByteArray configHash( void );
+
+        //* switch to the matches of another configuration
+        void reset( const QByteArray& configHash, const QHash<QString, int>& matches );
+
+        //* cached class match for given window class, or -1 if none
+        int classIndex( const QString& windowClass ) const
+        { return m_matches.value( windowClass, -1 ); }
+
+        //* store class match
+        void insert( const QString& windowClass, int classIndex );
+
+        //* verify cached class match on the worker threads, once per configuration
+        void verify( const QString& windowClass, SettingsProvider::SnapshotPtr );
+
+        Q_SIGNALS:
+
+        //* emitted when a cached class match turned out to be wrong, and was corrected
+        void corrected( const QString& windowClass );
+
+        private Q_SLOTS:
+
+        //* write to disk, dropping stale window classes past the maximum number of entries
+        void save( void );
+
+        //* write pending changes, before the application goes away
+        void shutdown( void );
+
+        private:
+
+        //* constructor
+        ResolutionCache( void );
+
+        //* cache file
+        static QString fileName( void );
+
+        //* configuration hash the matches are valid for
+        QByteArray m_configHash;
+
+        //* class matches, by window class
+        QHash<QString, int> m_matches;
+
+        //* window classes verified for this configuration
+        QSet<QString> m_verified;
+
+        //* delays and groups writes
+        QTimer m_saveTimer;
+
+    };
+
+}
+
+#endif
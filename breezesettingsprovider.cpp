@@ -20,21 +20,46 @@
 
 #include "breezesettingsprovider.h"
 
+#include "breezeconfigblob.h"
+#include "breezedecoration.h"
 #include "breezeexceptionlist.h"
+#include "breezeimagecache.h"
+#include "breezeresolutioncache.h"
+#include "breezestats.h"
+#include "breezewindowpropertycache.h"
 
-#include <KWindowInfo>
+#include <KConfigGroup>
 
+#include <QBitArray>
+#include <QDir>
+#include <QFile>
 #include <QTextStream>
+#include <QTimer>
+#include <QtConcurrentRun>
+
 
 namespace SierraBreeze
 {
 
     SettingsProvider *SettingsProvider::s_self = nullptr;
+    SettingsProvider::SnapshotPtr SettingsProvider::s_snapshot;
+    QFuture<SettingsProvider::Prefetch> SettingsProvider::s_warmUp;
 
     //__________________________________________________________________
     SettingsProvider::SettingsProvider():
         m_config( KSharedConfig::openConfig( QStringLiteral("breezerc") ) )
-    { reconfigure(); }
+    {
+        // default constructed futures are canceled, meaning no warm-up was started
+        if( !s_warmUp.isCanceled() )
+        {
+
+            // waits for the worker thread, in case it is not done yet. The settings objects are created here, in the gui thread
+            const Prefetch prefetch( s_warmUp.result() );
+            s_warmUp = QFuture<Prefetch>();
+            publish( buildSnapshot( m_config, &prefetch ) );
+
+        } else reconfigure();
+    }
 
     //__________________________________________________________________
     SettingsProvider::~SettingsProvider()
@@ -43,41 +68,76 @@ namespace SierraBreeze
     //__________________________________________________________________
     SettingsProvider *SettingsProvider::self()
     {
-        // TODO: this is not thread safe!
+        // the provider lives in the gui thread. Other threads must only use snapshot()
         if (!s_self)
         { s_self = new SettingsProvider(); }
 
         return s_self;
     }
 
+    //__________________________________________________________________
+    QFuture<SettingsProvider::Prefetch> SettingsProvider::warmUp( void )
+    {
+        if( !s_self && s_warmUp.isCanceled() )
+        { s_warmUp = QtConcurrent::run( ImageCache::self().threadPool(), &SettingsProvider::prefetch ); }
+
+        return s_warmUp;
+    }
+
+    //__________________________________________________________________
+    SettingsProvider::Prefetch SettingsProvider::prefetch( void )
+    {
+        Prefetch prefetch;
+        prefetch.blob = ConfigBlob::load( prefetch.configHash );
+        if( prefetch.blob.isEmpty() ) prefetch.configHash = ResolutionCache::configHash();
+        prefetch.classMatches = ResolutionCache::read( prefetch.configHash );
+        prefetch.konsoleColors = readKonsoleColors();
+        return prefetch;
+    }
+
     //__________________________________________________________________
     void SettingsProvider::reconfigure( void )
     {
-        if( !m_defaultSettings )
+        m_reconfigurePending = false;
+        publish( buildSnapshot( m_config ) );
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::reconfigureDelayed( void )
+    {
+        if( m_reconfigurePending )
         {
-            m_defaultSettings = InternalSettingsPtr(new InternalSettings());
-            m_defaultSettings->setCurrentGroup( QStringLiteral("Windeco") );
+            Stats::self().increment( Stats::CoalescedReconfigures );
+            return;
         }
 
-        m_defaultSettings->load();
-
-        ExceptionList exceptions;
-        exceptions.readConfig( m_config );
-        m_exceptions = exceptions.get();
-
+        m_reconfigurePending = true;
+        QTimer::singleShot( 0, this, [this]() { if( m_reconfigurePending ) reconfigure(); } );
     }
 
     //__________________________________________________________________
-    InternalSettingsPtr SettingsProvider::internalSettings( Decoration *decoration ) const
+    SettingsProvider::SnapshotPtr SettingsProvider::buildSnapshot( KSharedConfigPtr config, const Prefetch* prefetch )
     {
+        // build next snapshot off to the side
+        std::shared_ptr<Snapshot> next( new Snapshot() );
 
-        QString windowTitle;
-        QString className;
+        // use the compiled configuration when up to date, and parse the configuration otherwise
+        const bool compiled( prefetch ?
+            ConfigBlob::read( prefetch->blob, next->defaultSettings, next->exceptions ) :
+            ConfigBlob::read( next->defaultSettings, next->exceptions, next->configHash ) );
+        if( !compiled )
+        {
+            next->defaultSettings = InternalSettingsPtr( new InternalSettings( config ) );
+            next->defaultSettings->setCurrentGroup( QStringLiteral("Windeco") );
+            next->defaultSettings->load();
 
-        // get the client
-        auto client = decoration->client().data();
+            ExceptionList exceptions;
+            exceptions.readConfig( config );
+            next->exceptions = exceptions.get();
+        }
 
-        foreach( auto internalSettings, m_exceptions )
+        // compile exception patterns once
+        foreach( auto internalSettings, next->exceptions )
         {
 
             // discard disabled exceptions
@@ -86,44 +146,379 @@ namespace SierraBreeze
             // discard exceptions with empty exception pattern
             if( internalSettings->exceptionPattern().isEmpty() ) continue;
 
-            /*
-            decide which value is to be compared
-            to the regular expression, based on exception type
-            */
-            QString value;
-            switch( internalSettings->exceptionType() )
+            const CompiledException exception( CompiledException::compile( internalSettings ) );
+            next->compiledExceptions.append( exception );
+
+            if( exception.type == InternalSettings::ExceptionWindowTitle )
+            { next->hasTitleExceptions = true; }
+
+        }
+
+        if( prefetch )
+        {
+
+            next->konsoleColors = prefetch->konsoleColors;
+            next->configHash = prefetch->configHash;
+            next->classMatches = prefetch->classMatches;
+
+        } else {
+
+            next->konsoleColors = readKonsoleColors();
+
+            // persisted class matches, only if built against the same configuration, identified by the blob stamp when compiled
+            if( !compiled ) next->configHash = ResolutionCache::configHash();
+            next->classMatches = ResolutionCache::read( next->configHash );
+
+        }
+
+        return next;
+
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::publish( SnapshotPtr next )
+    {
+
+        // find what changed
+        const SnapshotPtr previous( snapshot() );
+        SettingsChanges changes( AllChanges );
+        if( previous )
+        {
+            changes = compare( previous->defaultSettings, next->defaultSettings );
+            if( !sameExceptions( previous->exceptions, next->exceptions ) ) changes |= ExceptionsChanged;
+            if( previous->konsoleColors != next->konsoleColors ) changes |= KonsoleChanged;
+        }
+
+        // publish
+        std::atomic_store( &s_snapshot, next );
+
+        // persisted class matches follow the configuration file
+        if( !previous || previous->configHash != next->configHash )
+        { ResolutionCache::self().reset( next->configHash, next->classMatches ); }
+
+        // match all decorations in one pass, before they pick up their settings
+        matchAll();
+        emit reconfigured( changes );
+        m_batch.clear();
+
+    }
+
+    //__________________________________________________________________
+    SettingsChanges SettingsProvider::compare( const InternalSettingsPtr& first, const InternalSettingsPtr& second )
+    {
+
+        if( first == second ) return NoChanges;
+        if( !( first && second ) ) return AllChanges;
+
+        SettingsChanges changes;
+
+        // shadow
+        if( first->shadowSize() != second->shadowSize() ||
+            first->shadowStrength() != second->shadowStrength() ||
+            first->shadowColor() != second->shadowColor() )
+        { changes |= ShadowChanged; }
+
+        // borders
+        if( ( first->mask() & BorderSize ) != ( second->mask() & BorderSize ) ||
+            first->borderSize() != second->borderSize() ||
+            first->hideTitleBar() != second->hideTitleBar() ||
+            first->buttonSize() != second->buttonSize() ||
+            first->drawBorderOnMaximizedWindows() != second->drawBorderOnMaximizedWindows() )
+        { changes |= BordersChanged; }
+
+        // buttons
+        if( first->buttonSpacing() != second->buttonSpacing() ||
+            first->buttonHPadding() != second->buttonHPadding() )
+        { changes |= ButtonsChanged; }
+
+        // animations
+        if( first->animationsEnabled() != second->animationsEnabled() ||
+            first->animationsDuration() != second->animationsDuration() ||
+            first->lowPowerMode() != second->lowPowerMode() )
+        { changes |= AnimationsChanged; }
+
+        // size grip
+        if( first->drawSizeGrip() != second->drawSizeGrip() )
+        { changes |= SizeGripChanged; }
+
+        // appearance
+        if( first->titleAlignment() != second->titleAlignment() ||
+            first->drawTitleBarSeparator() != second->drawTitleBarSeparator() ||
+            first->drawBackgroundGradient() != second->drawBackgroundGradient() ||
+            first->matchColorForTitleBar() != second->matchColorForTitleBar() ||
+            first->outlineCloseButton() != second->outlineCloseButton() ||
+            first->lowPowerMode() != second->lowPowerMode() )
+        { changes |= AppearanceChanged; }
+
+        return changes;
+
+    }
+
+    //__________________________________________________________________
+    bool SettingsProvider::sameExceptions( const InternalSettingsList& first, const InternalSettingsList& second )
+    {
+
+        if( first.size() != second.size() ) return false;
+        for( int i = 0; i < first.size(); ++i )
+        {
+            const InternalSettingsPtr& a( first[i] );
+            const InternalSettingsPtr& b( second[i] );
+            if( a->enabled() != b->enabled() ||
+                a->exceptionType() != b->exceptionType() ||
+                a->exceptionPattern() != b->exceptionPattern() ||
+                a->exceptionPatternKind() != b->exceptionPatternKind() ||
+                compare( a, b ) != NoChanges )
+            { return false; }
+        }
+
+        return true;
+
+    }
+
+    //__________________________________________________________________
+    SettingsProvider::KonsoleColors SettingsProvider::readKonsoleColors( void )
+    {
+        KonsoleColors colors;
+
+        const KConfig konsoleConfig("konsolerc");
+        const QString defaultProfileFile = konsoleConfig.group("Desktop Entry").readEntry("DefaultProfile", QString());
+
+        // Konsole config profile path
+        const QString configLocation(QDir::homePath() + "/.local/share/konsole/");
+        const QString shellProfileLocation(configLocation + defaultProfileFile);
+
+        if (!QFile::exists(shellProfileLocation)) {
+            return colors;
+        }
+
+        const KConfig configProfile(shellProfileLocation, KConfig::NoGlobals);
+
+        const QString colorFileLocation = configLocation + configProfile.group("Appearance").readEntry("ColorScheme", QString()) + ".colorscheme";
+
+        if (!QFile::exists(colorFileLocation)) {
+            return colors;
+        }
+
+        const KConfig configColor(colorFileLocation, KConfig::NoGlobals);
+        const QStringList backgroundRGB = configColor.group("Background").readEntry("Color").split(',');
+
+        if (backgroundRGB.size() != 3) {
+            return colors;
+        }
+
+        colors.titleBarColor.setRed(backgroundRGB[0].toInt());
+        colors.titleBarColor.setGreen(backgroundRGB[1].toInt());
+        colors.titleBarColor.setBlue(backgroundRGB[2].toInt());
+
+        colors.titleBarColor.setAlpha(configColor.group("General").readEntry("Opacity").toFloat() * 255);
+
+        // Text color
+        const QStringList foregroundRGB = configColor.group("Foreground").readEntry("Color").split(',');
+
+        if (foregroundRGB.size() != 3) {
+            return colors;
+        }
+
+        colors.textColorActive.setRed(foregroundRGB[0].toInt());
+        colors.textColorActive.setGreen(foregroundRGB[1].toInt());
+        colors.textColorActive.setBlue(foregroundRGB[2].toInt());
+
+        colors.textColorInactive = colors.textColorActive;
+        colors.textColorInactive.setAlphaF(0.5);
+
+        colors.valid = true;
+        return colors;
+    }
+
+    //__________________________________________________________________
+    template<typename Matches>
+    static SettingsProvider::Match resolve( const SettingsProvider::SnapshotPtr& snapshot, Matches matches )
+    {
+
+        SettingsProvider::Match match;
+        match.snapshot = snapshot;
+
+        const QVector<CompiledException>& exceptions( snapshot->compiledExceptions );
+        match.classIndex = exceptions.size();
+        for( int i = 0; i < exceptions.size(); ++i )
+        {
+
+            // once a title exception matched, only the first matching class exception is still needed
+            const bool isTitle( exceptions[i].type == InternalSettings::ExceptionWindowTitle );
+            if( isTitle && match.settings ) continue;
+
+            // check matching
+            if( !matches( i ) ) continue;
+            if( !match.settings ) match.settings = exceptions[i].settings;
+            if( !isTitle )
             {
-                case InternalSettings::ExceptionWindowTitle:
+                match.classIndex = i;
+                break;
+            }
+
+        }
+
+        if( !match.settings ) match.settings = snapshot->defaultSettings;
+        return match;
+
+    }
+
+    //__________________________________________________________________
+    SettingsProvider::Match SettingsProvider::match( Decoration *decoration ) const
+    {
+
+        // use the batch result, if any
+        const SnapshotPtr snapshot( this->snapshot() );
+        const auto iter( m_batch.constFind( decoration ) );
+        if( iter != m_batch.constEnd() && iter->snapshot == snapshot ) return *iter;
+
+        // get the client
+        auto client = decoration->client().data();
+        const QString className( WindowPropertyCache::self().entry( client->windowId() ).windowClass() );
+
+        // use the persisted class match right away, and verify it in the background
+        const int classIndex( ResolutionCache::self().classIndex( className ) );
+        if( classIndex >= 0 && classIndex <= snapshot->compiledExceptions.size() )
+        {
+            ResolutionCache::self().verify( className, snapshot );
+
+            Match cached;
+            cached.snapshot = snapshot;
+            cached.classIndex = classIndex;
+            return matchTitle( decoration, cached );
+        }
+
+        QString windowTitle;
+        const Match match( resolve( snapshot, [&]( int i )
+            {
+
+                /*
+                decide which value is to be compared
+                to the regular expression, based on exception type
+                */
+                const CompiledException& exception( snapshot->compiledExceptions[i] );
+                if( exception.type == InternalSettings::ExceptionWindowTitle )
                 {
-                    value = windowTitle.isEmpty() ? (windowTitle = client->caption()):windowTitle;
-                    break;
-                }
 
-                default:
-                case InternalSettings::ExceptionWindowClassName:
+                    if( windowTitle.isEmpty() ) windowTitle = client->caption();
+                    return exception.matches( windowTitle );
+
+                } else return exception.matches( className );
+            } ) );
+
+        ResolutionCache::self().insert( className, match.classIndex );
+        return match;
+
+    }
+
+    //__________________________________________________________________
+    int SettingsProvider::classMatch( const SnapshotPtr& snapshot, const QString& windowClass )
+    {
+        const QVector<CompiledException>& exceptions( snapshot->compiledExceptions );
+        for( int i = 0; i < exceptions.size(); ++i )
+        {
+            if( exceptions[i].type != InternalSettings::ExceptionWindowTitle && exceptions[i].matches( windowClass ) )
+            { return i; }
+        }
+
+        return exceptions.size();
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::matchAll( void )
+    {
+
+        m_batch.clear();
+
+        const SnapshotPtr snapshot( this->snapshot() );
+        const QVector<CompiledException>& exceptions( snapshot->compiledExceptions );
+        if( m_decorations.isEmpty() || exceptions.isEmpty() ) return;
+
+        // collect distinct classes and titles over all decorations
+        class Window
+        {
+            public:
+            Decoration* decoration;
+            int classIndex;
+            int titleIndex;
+        };
+
+        QVector<Window> windows;
+        QStringList classes;
+        QStringList titles;
+        QHash<QString, int> classIndexes;
+        QHash<QString, int> titleIndexes;
+        windows.reserve( m_decorations.size() );
+        for( Decoration* decoration : m_decorations )
+        {
+            auto client = decoration->client().data();
+
+            const QString className( WindowPropertyCache::self().entry( client->windowId() ).windowClass() );
+            auto classIter( classIndexes.constFind( className ) );
+            if( classIter == classIndexes.constEnd() )
+            {
+                classIter = classIndexes.insert( className, classes.size() );
+                classes.append( className );
+            }
+
+            int titleIndex = -1;
+            if( snapshot->hasTitleExceptions )
+            {
+                const QString title( client->caption() );
+                auto titleIter( titleIndexes.constFind( title ) );
+                if( titleIter == titleIndexes.constEnd() )
                 {
-                    if( className.isEmpty() )
-                    {
-                        // retrieve class name
-                        KWindowInfo info( client->windowId(), 0, NET::WM2WindowClass );
-                        QString window_className( QString::fromUtf8(info.windowClassName()) );
-                        QString window_class( QString::fromUtf8(info.windowClassClass()) );
-                        className = window_className + QStringLiteral(" ") + window_class;
-                    }
-
-                    value = className;
-                    break;
+                    titleIter = titleIndexes.insert( title, titles.size() );
+                    titles.append( title );
                 }
 
+                titleIndex = titleIter.value();
             }
 
-            // check matching
-            if( QRegExp( internalSettings->exceptionPattern() ).indexIn( value ) >= 0 )
-            { return internalSettings; }
+            windows.append( { decoration, classIter.value(), titleIndex } );
+        }
 
+        // evaluate each pattern once over the distinct values of its type
+        const QVector<QBitArray> results( CompiledException::matchAll( exceptions, classes, titles ) );
+
+        // resolve all decorations from the results
+        for( const Window& window : windows )
+        {
+            const Match match( resolve( snapshot, [&exceptions, &results, &window]( int i )
+                {
+                    const bool isTitle( exceptions[i].type == InternalSettings::ExceptionWindowTitle );
+                    return results[i].testBit( isTitle ? window.titleIndex : window.classIndex );
+                } ) );
+
+            m_batch.insert( window.decoration, match );
+            ResolutionCache::self().insert( classes[window.classIndex], match.classIndex );
+        }
+
+    }
+
+    //__________________________________________________________________
+    SettingsProvider::Match SettingsProvider::matchTitle( Decoration *decoration, const Match& previous ) const
+    {
+
+        // class matches are only valid for the snapshot they were made against
+        if( previous.snapshot != snapshot() ) return match( decoration );
+
+        Match match( previous );
+        const QVector<CompiledException>& exceptions( match.snapshot->compiledExceptions );
+        const QString windowTitle( decoration->client().data()->caption() );
+        for( int i = 0; i < match.classIndex; ++i )
+        {
+            const CompiledException& exception( exceptions[i] );
+            if( exception.type == InternalSettings::ExceptionWindowTitle && exception.matches( windowTitle ) )
+            {
+                match.settings = exception.settings;
+                return match;
+            }
         }
 
-        return m_defaultSettings;
+        // no title match, use the class match if any
+        match.settings = match.classIndex < exceptions.size() ? exceptions[match.classIndex].settings : match.snapshot->defaultSettings;
+        return match;
 
     }
 
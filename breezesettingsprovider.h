@@ -20,17 +20,26 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "breezedecoration.h"
+#include "breezecompiledexception.h"
 #include "breezesettings.h"
 #include "breeze.h"
 
 #include <KSharedConfig>
 
+#include <QByteArray>
+#include <QColor>
+#include <QFuture>
+#include <QHash>
 #include <QObject>
+#include <QSet>
+#include <QVector>
+
+#include <memory>
 
 namespace SierraBreeze
 {
 
+    class Decoration;
     class SettingsProvider: public QObject
     {
 
@@ -44,31 +53,204 @@ namespace SierraBreeze
         //* singleton
         static SettingsProvider *self();
 
-        //* internal settings for given decoration
-        InternalSettingsPtr internalSettings(Decoration *) const;
+        //* konsole profile colors
+        class KonsoleColors
+        {
+            public:
+
+            //* equal to operator
+            bool operator == ( const KonsoleColors& other ) const
+            {
+                return
+                    valid == other.valid &&
+                    titleBarColor == other.titleBarColor &&
+                    textColorActive == other.textColorActive &&
+                    textColorInactive == other.textColorInactive;
+            }
+
+            //* different from operator
+            bool operator != ( const KonsoleColors& other ) const
+            { return !( *this == other ); }
+
+            QColor titleBarColor;
+            QColor textColorActive;
+            QColor textColorInactive;
+            bool valid = false;
+        };
+
+        /**
+        immutable configuration, as published by the provider
+        a new snapshot is built on every reconfigure and swapped in atomically,
+        so that it can be read from any thread without locking
+        */
+        class Snapshot
+        {
+            public:
+
+            //* default configuration
+            InternalSettingsPtr defaultSettings;
+
+            //* exceptions, as read from the configuration
+            InternalSettingsList exceptions;
+
+            //* enabled exceptions, with non empty patterns, in matching order
+            QVector<CompiledException> compiledExceptions;
+
+            //* konsole colors
+            KonsoleColors konsoleColors;
+
+            //* true if at least one compiled exception matches on window title
+            bool hasTitleExceptions = false;
+
+            //* hash of the configuration file
+            QByteArray configHash;
+
+            //* class matches persisted for this configuration, by window class
+            QHash<QString, int> classMatches;
+        };
+
+        using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+        /**
+        configuration data read on the worker threads at plugin load.
+        Plain values only: the settings, which are QObjects backed by a KSharedConfig,
+        are created from it in the gui thread
+        */
+        class Prefetch
+        {
+            public:
+
+            //* compiled configuration, as returned by ConfigBlob::load. Empty if missing or stale
+            QByteArray blob;
+
+            //* konsole colors
+            KonsoleColors konsoleColors;
+
+            //* hash of the configuration file
+            QByteArray configHash;
+
+            //* class matches persisted for this configuration, by window class
+            QHash<QString, int> classMatches;
+        };
+
+        //* result of matching a decoration against the exceptions
+        class Match
+        {
+            public:
+
+            //* snapshot the match was made against
+            SnapshotPtr snapshot;
+
+            //* index of the first matching class exception, or number of compiled exceptions if none
+            int classIndex = 0;
+
+            //* matched settings
+            InternalSettingsPtr settings;
+        };
+
+        //*@name decorations, matched together on reconfigure
+        //@{
+        void registerDecoration( Decoration* decoration )
+        { m_decorations.insert( decoration ); }
+
+        void unregisterDecoration( Decoration* decoration )
+        {
+            m_decorations.remove( decoration );
+            m_batch.remove( decoration );
+        }
+        //@}
+
+        //* match all exceptions for given decoration
+        Match match( Decoration* ) const;
+
+        //* index of the first class exception matching window class, or number of compiled exceptions if none. Safe to call from any thread
+        static int classMatch( const SnapshotPtr&, const QString& windowClass );
+
+        /**
+        match title exceptions again, keeping the class match.
+        Only title exceptions placed before the matching class exception are checked.
+        Falls back to a full match if the snapshot changed in the meantime
+        */
+        Match matchTitle( Decoration*, const Match& ) const;
+
+        //* current snapshot. Safe to call from any thread
+        static SnapshotPtr snapshot( void )
+        { return std::atomic_load( &s_snapshot ); }
+
+        //* konsole profile colors
+        KonsoleColors konsoleColors( void ) const
+        { return snapshot()->konsoleColors; }
+
+        /**
+        start reading the configuration on the worker threads.
+        Called at plugin load, so that the first snapshot is built without touching the disk
+        */
+        static QFuture<Prefetch> warmUp( void );
+
+        //* changes needed to go from one set of settings to the other
+        static SettingsChanges compare( const InternalSettingsPtr&, const InternalSettingsPtr& );
+
+        Q_SIGNALS:
+
+        //* emitted at the end of reconfigure, with the changes found in the configuration
+        void reconfigured( SettingsChanges );
 
         public Q_SLOTS:
 
         //* reconfigure
         void reconfigure( void );
 
+        //* reconfigure once on the next event loop turn, however many times requested
+        void reconfigureDelayed( void );
+
         private:
 
         //* contructor
         SettingsProvider( void );
 
-        //* default configuration
-        InternalSettingsPtr m_defaultSettings;
+        //* read configuration data. Safe to call from any thread
+        static Prefetch prefetch( void );
+
+        //* build a snapshot from the configuration, or from data prefetched at plugin load if any
+        static SnapshotPtr buildSnapshot( KSharedConfigPtr, const Prefetch* = nullptr );
+
+        //* publish snapshot and notify about the changes
+        void publish( SnapshotPtr );
+
+        /**
+        match all registered decorations at once.
+        Distinct classes and titles are collected first, then each pattern is evaluated once
+        over them, in parallel for large sets. Results are used by match() during the next emission
+        */
+        void matchAll( void );
+
+        //* true if both exception lists match the same windows with the same settings
+        static bool sameExceptions( const InternalSettingsList&, const InternalSettingsList& );
 
-        //* exceptions
-        InternalSettingsList m_exceptions;
+        //* read konsole default profile colors
+        static KonsoleColors readKonsoleColors( void );
 
         //* config object
         KSharedConfigPtr m_config;
 
+        //* live decorations
+        QSet<Decoration*> m_decorations;
+
+        //* true when a delayed reconfigure is scheduled
+        bool m_reconfigurePending = false;
+
+        //* batch match results, by decoration
+        QHash<Decoration*, Match> m_batch;
+
         //* singleton
         static SettingsProvider *s_self;
 
+        //* published snapshot
+        static SnapshotPtr s_snapshot;
+
+        //* configuration being read at plugin load
+        static QFuture<Prefetch> s_warmUp;
+
     };
 
 }
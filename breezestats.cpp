@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezestats.h"
+
+#include <QCoreApplication>
+
+Q_LOGGING_CATEGORY(SIERRABREEZE, "sierrabreeze", QtInfoMsg)
+
+namespace SierraBreeze
+{
+
+    //* weight of the last paint in the moving average
+    static const qreal PaintTimeWeight = 1.0/16;
+
+    //__________________________________________________________________
+    Stats& Stats::self( void )
+    {
+        // allocated once, and never deleted, see shutdown
+        static Stats* stats( new Stats() );
+        return *stats;
+    }
+
+    //__________________________________________________________________
+    Stats::Stats( void )
+    {
+        for( auto& counter : m_counters )
+        { counter = 0; }
+
+        connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &Stats::shutdown );
+    }
+
+    //__________________________________________________________________
+    void Stats::shutdown( void )
+    {
+        if( value( Paints ) > 0 )
+        { qCInfo( SIERRABREEZE ) << "exiting." << qPrintable( toString() ); }
+    }
+
+    //__________________________________________________________________
+    void Stats::addPaintTime( qint64 time, int budget )
+    {
+
+        increment( Paints );
+        if( m_reducedQuality ) increment( ReducedQualityPaints );
+
+        m_averagePaintTime += ( time/1000.0 - m_averagePaintTime )*PaintTimeWeight;
+
+        // hysteresis, so that quality does not flip at each frame
+        bool reducedQuality( m_reducedQuality );
+        if( budget <= 0 ) reducedQuality = false;
+        else if( !m_reducedQuality && m_averagePaintTime > budget ) reducedQuality = true;
+        else if( m_reducedQuality && m_averagePaintTime < budget/2 ) reducedQuality = false;
+
+        if( reducedQuality == m_reducedQuality ) return;
+        m_reducedQuality = reducedQuality;
+
+        qCInfo( SIERRABREEZE ) << ( reducedQuality ? "frame budget exceeded, reducing quality." : "back within frame budget, restoring quality." )
+            << qPrintable( toString() );
+
+        emit reducedQualityChanged( reducedQuality );
+
+    }
+
+    //__________________________________________________________________
+    QString Stats::toString( void ) const
+    {
+        return QStringLiteral( "quality: %1, average paint: %2us, paints: %3 (%4 reduced), coalesced reconfigures: %5, coalesced button layouts: %6" )
+            .arg( m_reducedQuality ? QStringLiteral( "reduced" ) : QStringLiteral( "full" ) )
+            .arg( m_averagePaintTime, 0, 'f', 1 )
+            .arg( value( Paints ) )
+            .arg( value( ReducedQualityPaints ) )
+            .arg( value( CoalescedReconfigures ) )
+            .arg( value( CoalescedButtonLayouts ) );
+    }
+
+}
@@ -0,0 +1,112 @@
+#ifndef breezestats_h
+#define breezestats_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QLoggingCategory>
+#include <QObject>
+
+Q_DECLARE_LOGGING_CATEGORY(SIERRABREEZE)
+
+namespace SierraBreeze
+{
+
+    /**
+    runtime statistics, shared by all decorations.
+    Also decides when rendering quality must be reduced to stay within the frame budget.
+    The statistics are never deleted: they are logged once more when the application is about to quit
+    */
+    class Stats: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* counters
+        enum Counter
+        {
+            Paints,
+            ReducedQualityPaints,
+            CoalescedReconfigures,
+            CoalescedButtonLayouts,
+            CounterCount
+        };
+
+        //* singleton
+        static Stats& self( void );
+
+        //*@name counters
+        //@{
+        void increment( Counter counter, qint64 count = 1 )
+        { m_counters[counter] += count; }
+
+        qint64 value( Counter counter ) const
+        { return m_counters[counter]; }
+        //@}
+
+        //* average paint time, in microseconds
+        qreal averagePaintTime( void ) const
+        { return m_averagePaintTime; }
+
+        /**
+        record time spent in one decoration paint, in nanoseconds,
+        and compare the moving average to the budget, in microseconds.
+        Quality is reduced above the budget, and restored below half of it
+        */
+        void addPaintTime( qint64 time, int budget );
+
+        //* true when rendering quality is reduced
+        bool reducedQuality( void ) const
+        { return m_reducedQuality; }
+
+        //* summary, for logging
+        QString toString( void ) const;
+
+        Q_SIGNALS:
+
+        //* emitted when quality is reduced or restored
+        void reducedQualityChanged( bool );
+
+        private Q_SLOTS:
+
+        //* log the final counters, before the application goes away
+        void shutdown( void );
+
+        private:
+
+        //* constructor
+        Stats( void );
+
+        //* counters
+        qint64 m_counters[CounterCount];
+
+        //* moving average of paint time, in microseconds
+        qreal m_averagePaintTime = 0;
+
+        //* reduced quality mode
+        bool m_reducedQuality = false;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezestyleresources.h"
+
+#include <QHash>
+#include <QPalette>
+#include <QWeakPointer>
+
+namespace SierraBreeze
+{
+
+    using KDecoration2::ColorRole;
+    using KDecoration2::ColorGroup;
+
+    //__________________________________________________________________
+    StyleResourcesPtr StyleResources::get( KDecoration2::DecoratedClient* client )
+    {
+
+        // resources in use, by palette. Only accessed from the gui thread
+        static QHash<qint64, QWeakPointer<const StyleResources>> resources;
+
+        const qint64 key( client->palette().cacheKey() );
+        StyleResourcesPtr out( resources.value( key ).toStrongRef() );
+        if( out ) return out;
+
+        // drop resources no decoration uses anymore
+        for( auto iter = resources.begin(); iter != resources.end(); )
+        {
+            if( iter.value().isNull() ) iter = resources.erase( iter );
+            else ++iter;
+        }
+
+        out = StyleResourcesPtr( new StyleResources( client ) );
+        resources.insert( key, out );
+        return out;
+
+    }
+
+    //__________________________________________________________________
+    const QColor& StyleResources::hintColor( void )
+    {
+        static const QColor color( 41, 43, 50, 200 );
+        return color;
+    }
+
+    //__________________________________________________________________
+    StyleResources::StyleResources( KDecoration2::DecoratedClient* client )
+    {
+
+        const QPalette palette( client->palette() );
+
+        for( const bool active : { false, true } )
+        {
+            const ColorGroup group( active ? ColorGroup::Active : ColorGroup::Inactive );
+            m_titleBarColor[active] = client->color( group, ColorRole::TitleBar );
+            m_fontColor[active] = client->color( group, ColorRole::Foreground );
+            m_frameBrush[active] = QBrush( client->color( group, ColorRole::Frame ) );
+        }
+
+        m_borderPen[true] = QPen( m_titleBarColor[true] );
+        m_borderPen[false] = QPen( m_fontColor[false] );
+
+        m_windowColor = palette.color( QPalette::Window );
+        m_highlightColor = palette.color( QPalette::Highlight );
+        m_warningColor = client->color( ColorGroup::Warning, ColorRole::Foreground );
+        m_warningHoverColor = m_warningColor.lighter();
+
+        m_titleBarTransition = ColorTransition::mix( m_titleBarColor[false], m_titleBarColor[true] );
+        m_fontTransition = ColorTransition::mix( m_fontColor[false], m_fontColor[true] );
+        m_outlineTransition = ColorTransition::fade( m_highlightColor );
+
+    }
+
+}
@@ -0,0 +1,127 @@
+#ifndef breezestyleresources_h
+#define breezestyleresources_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecolortransition.h"
+
+#include <KDecoration2/DecoratedClient>
+
+#include <QBrush>
+#include <QColor>
+#include <QPen>
+#include <QSharedPointer>
+
+namespace SierraBreeze
+{
+
+    class StyleResources;
+    using StyleResourcesPtr = QSharedPointer<const StyleResources>;
+
+    /**
+    colors, pens and brushes resolved once per palette,
+    and shared by all the decorations using it.
+    Fonts are not included, they are already shared by the decoration settings
+    */
+    class StyleResources
+    {
+
+        public:
+
+        //* resources matching the client palette. Created on first use, released with the last decoration
+        static StyleResourcesPtr get( KDecoration2::DecoratedClient* );
+
+        //* hint color, drawn over hovered buttons
+        static const QColor& hintColor( void );
+
+        //*@name colors, for given active state
+        //@{
+
+        const QColor& titleBarColor( bool active ) const
+        { return m_titleBarColor[active]; }
+
+        const QColor& fontColor( bool active ) const
+        { return m_fontColor[active]; }
+
+        const QBrush& frameBrush( bool active ) const
+        { return m_frameBrush[active]; }
+
+        //* outline, for windows without alpha channel
+        const QPen& borderPen( bool active ) const
+        { return m_borderPen[active]; }
+
+        //@}
+
+        //*@name palette colors
+        //@{
+
+        const QColor& windowColor( void ) const
+        { return m_windowColor; }
+
+        const QColor& highlightColor( void ) const
+        { return m_highlightColor; }
+
+        const QColor& warningColor( void ) const
+        { return m_warningColor; }
+
+        const QColor& warningHoverColor( void ) const
+        { return m_warningHoverColor; }
+
+        //@}
+
+        //*@name active state change colors
+        //@{
+
+        const ColorTransition& titleBarTransition( void ) const
+        { return m_titleBarTransition; }
+
+        const ColorTransition& fontTransition( void ) const
+        { return m_fontTransition; }
+
+        const ColorTransition& outlineTransition( void ) const
+        { return m_outlineTransition; }
+
+        //@}
+
+        private:
+
+        //* constructor
+        explicit StyleResources( KDecoration2::DecoratedClient* );
+
+        QColor m_titleBarColor[2];
+        QColor m_fontColor[2];
+        QBrush m_frameBrush[2];
+        QPen m_borderPen[2];
+
+        QColor m_windowColor;
+        QColor m_highlightColor;
+        QColor m_warningColor;
+        QColor m_warningHoverColor;
+
+        ColorTransition m_titleBarTransition;
+        ColorTransition m_fontTransition;
+        ColorTransition m_outlineTransition;
+
+    };
+
+}
+
+#endif
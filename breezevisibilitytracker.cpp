@@ -0,0 +1,95 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezevisibilitytracker.h"
+#include "breezedecoration.h"
+
+#include <KDecoration2/DecoratedClient>
+#include <KWindowSystem>
+
+#include <QCoreApplication>
+
+namespace SierraBreeze
+{
+
+    //__________________________________________________________________
+    VisibilityTracker& VisibilityTracker::self( void )
+    {
+        // allocated once, and never deleted, see shutdown
+        static VisibilityTracker* tracker( new VisibilityTracker() );
+        return *tracker;
+    }
+
+    //__________________________________________________________________
+    VisibilityTracker::VisibilityTracker( void )
+    {
+        connect( &WindowPropertyCache::self(), &WindowPropertyCache::propertiesChanged, this, &VisibilityTracker::propertiesChanged );
+        connect( KWindowSystem::self(), &KWindowSystem::currentDesktopChanged, this, &VisibilityTracker::currentDesktopChanged );
+        connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &VisibilityTracker::shutdown );
+    }
+
+    //__________________________________________________________________
+    void VisibilityTracker::shutdown( void )
+    {
+        disconnect( &WindowPropertyCache::self(), nullptr, this, nullptr );
+        disconnect( KWindowSystem::self(), nullptr, this, nullptr );
+        m_decorations.clear();
+    }
+
+    //__________________________________________________________________
+    void VisibilityTracker::registerDecoration( WId window, Decoration* decoration )
+    { if( window ) m_decorations.insert( window, decoration ); }
+
+    //__________________________________________________________________
+    void VisibilityTracker::unregisterDecoration( WId window )
+    { m_decorations.remove( window ); }
+
+    //__________________________________________________________________
+    bool VisibilityTracker::isVisible( const Decoration* decoration )
+    {
+        // no window id, e.g. on wayland. Desktop changes are not tracked, assume visible
+        const auto client( decoration->client().data() );
+        if( !( client && client->windowId() ) ) return true;
+
+        // desktop, from the client and the window system's cached root info
+        if( !( client->isOnAllDesktops() || client->desktop() == KWindowSystem::currentDesktop() ) ) return false;
+
+        // minimized windows are iconified by the window manager
+        return !WindowPropertyCache::self().entry( client->windowId() ).iconic;
+    }
+
+    //__________________________________________________________________
+    void VisibilityTracker::propertiesChanged( WId window, WindowPropertyCache::Properties properties )
+    {
+        if( !( properties & WindowPropertyCache::WindowState ) ) return;
+
+        const auto decoration( m_decorations.value( window ) );
+        if( decoration ) decoration->updateVisibility();
+    }
+
+    //__________________________________________________________________
+    void VisibilityTracker::currentDesktopChanged( int )
+    {
+        const auto decorations( m_decorations.values() );
+        for( const auto& decoration : decorations )
+        { if( decoration ) decoration->updateVisibility(); }
+    }
+
+}
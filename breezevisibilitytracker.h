@@ -0,0 +1,85 @@
+#ifndef breezevisibilitytracker_h
+#define breezevisibilitytracker_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezewindowpropertycache.h"
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+
+namespace SierraBreeze
+{
+
+    class Decoration;
+
+    /**
+    tracks whether decorated windows are minimized or on another virtual desktop.
+    A single tracker listens to the window system on behalf of all decorations.
+    Visibility is computed from cached state only: the client's desktop, the current desktop,
+    and the mapping state kept by WindowPropertyCache. Occlusion by other windows is not known
+    to decorations, and is not tracked. The tracker is never deleted: it stops listening
+    when the application is about to quit
+    */
+    class VisibilityTracker: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* singleton
+        static VisibilityTracker& self( void );
+
+        //*@name decorations
+        //@{
+        void registerDecoration( WId, Decoration* );
+        void unregisterDecoration( WId );
+        //@}
+
+        //* true if window is neither minimized nor on another desktop
+        static bool isVisible( const Decoration* );
+
+        private Q_SLOTS:
+
+        //* cached window properties changed
+        void propertiesChanged( WId, SierraBreeze::WindowPropertyCache::Properties );
+
+        //* current desktop changed
+        void currentDesktopChanged( int );
+
+        //* stop listening and forget decorations, before the application goes away
+        void shutdown( void );
+
+        private:
+
+        //* constructor
+        VisibilityTracker( void );
+
+        //* decorations, by window id
+        QHash<WId, QPointer<Decoration>> m_decorations;
+
+    };
+
+}
+
+#endif
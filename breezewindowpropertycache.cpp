@@ -0,0 +1,301 @@
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezewindowpropertycache.h"
+
+#include "config-breeze.h"
+
+#include <KWindowInfo>
+
+#include <QCoreApplication>
+#include <QScopedPointer>
+#include <QTimer>
+#include <QVector>
+
+#if BREEZE_HAVE_X11
+#include <QX11Info>
+#include <xcb/xcb.h>
+#endif
+
+namespace SierraBreeze
+{
+
+    #if BREEZE_HAVE_X11
+    //*@name atoms, requested once for the whole process
+    //@{
+    enum { AtomCount = 2 };
+    static xcb_intern_atom_cookie_t g_atomCookies[AtomCount];
+    static bool g_atomsRequested = false;
+    //@}
+
+    //__________________________________________________________________
+    static void requestAtoms( xcb_connection_t* connection )
+    {
+        if( g_atomsRequested ) return;
+        g_atomsRequested = true;
+
+        const QByteArray names[AtomCount] = { QByteArrayLiteral( "WM_WINDOW_ROLE" ), QByteArrayLiteral( "WM_STATE" ) };
+        for( int i = 0; i < AtomCount; ++i )
+        { g_atomCookies[i] = xcb_intern_atom( connection, false, names[i].size(), names[i].constData() ); }
+
+        // send now, so that the server answers while the plugin keeps loading
+        xcb_flush( connection );
+    }
+    #endif
+
+    //__________________________________________________________________
+    void WindowPropertyCache::warmUp( void )
+    {
+        #if BREEZE_HAVE_X11
+        if( QX11Info::isPlatformX11() ) requestAtoms( QX11Info::connection() );
+        #endif
+    }
+
+    //__________________________________________________________________
+    WindowPropertyCache& WindowPropertyCache::self( void )
+    {
+        // allocated once, and never deleted, see shutdown
+        static WindowPropertyCache* cache( new WindowPropertyCache() );
+        return *cache;
+    }
+
+    //__________________________________________________________________
+    WindowPropertyCache::WindowPropertyCache( void )
+    {
+
+        connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &WindowPropertyCache::shutdown );
+
+        #if BREEZE_HAVE_X11
+        if( !QX11Info::isPlatformX11() ) return;
+
+        // atoms were normally requested at plugin load, and their replies have arrived since
+        xcb_connection_t* connection( QX11Info::connection() );
+        requestAtoms( connection );
+
+        quint32* atoms[AtomCount] = { &m_roleAtom, &m_wmStateAtom };
+        for( int i = 0; i < AtomCount; ++i )
+        {
+            QScopedPointer<xcb_intern_atom_reply_t, QScopedPointerPodDeleter> reply( xcb_intern_atom_reply( connection, g_atomCookies[i], nullptr ) );
+            *atoms[i] = reply ? reply->atom : 0;
+        }
+
+        QCoreApplication::instance()->installNativeEventFilter( this );
+        #endif
+
+    }
+
+    //__________________________________________________________________
+    WindowPropertyCache::~WindowPropertyCache( void )
+    { shutdown(); }
+
+    //__________________________________________________________________
+    void WindowPropertyCache::shutdown( void )
+    {
+        if( QCoreApplication::instance() )
+        { QCoreApplication::instance()->removeNativeEventFilter( this ); }
+
+        m_entries.clear();
+        m_pending.clear();
+    }
+
+    //__________________________________________________________________
+    void WindowPropertyCache::registerWindow( WId window )
+    {
+        if( !window || m_entries.contains( window ) ) return;
+
+        m_entries.insert( window, Entry() );
+        fetch( { { window, AllProperties } } );
+    }
+
+    //__________________________________________________________________
+    void WindowPropertyCache::unregisterWindow( WId window )
+    {
+        m_entries.remove( window );
+        m_pending.remove( window );
+    }
+
+    //__________________________________________________________________
+    bool WindowPropertyCache::nativeEventFilter( const QByteArray& eventType, void* message, long* )
+    {
+
+        #if BREEZE_HAVE_X11
+        if( eventType != "xcb_generic_event_t" ) return false;
+
+        auto event = static_cast<xcb_generic_event_t*>( message );
+        if( ( event->response_type & ~0x80 ) != XCB_PROPERTY_NOTIFY ) return false;
+
+        auto propertyEvent = reinterpret_cast<xcb_property_notify_event_t*>( event );
+        if( !m_entries.contains( propertyEvent->window ) ) return false;
+
+        Properties properties;
+        if( propertyEvent->atom == XCB_ATOM_WM_CLASS ) properties = WindowClass;
+        else if( propertyEvent->atom == m_roleAtom ) properties = WindowRole;
+        else if( propertyEvent->atom == m_wmStateAtom ) properties = WindowState;
+        else return false;
+
+        // collect changes, and fetch them together on the next event loop turn
+        if( m_pending.isEmpty() ) QTimer::singleShot( 0, this, &WindowPropertyCache::fetchPending );
+        m_pending[propertyEvent->window] |= properties;
+        #else
+        Q_UNUSED( eventType )
+        Q_UNUSED( message )
+        #endif
+
+        // never filter out, kwin needs the event too
+        return false;
+
+    }
+
+    //__________________________________________________________________
+    void WindowPropertyCache::fetchPending( void )
+    {
+        const QHash<WId, Properties> pending( m_pending );
+        m_pending.clear();
+
+        const QHash<WId, Properties> changed( fetch( pending ) );
+        for( auto iter = changed.constBegin(); iter != changed.constEnd(); ++iter )
+        { emit propertiesChanged( iter.key(), iter.value() ); }
+    }
+
+    //__________________________________________________________________
+    QHash<WId, WindowPropertyCache::Properties> WindowPropertyCache::fetch( const QHash<WId, Properties>& requests )
+    {
+
+        QHash<WId, Properties> changed;
+
+        #if BREEZE_HAVE_X11
+        if( QX11Info::isPlatformX11() )
+        {
+
+            xcb_connection_t* connection( QX11Info::connection() );
+
+            // send all requests first, so that the whole batch costs a single round trip
+            struct Cookies
+            {
+                WId window;
+                Properties properties;
+                xcb_get_property_cookie_t windowClass;
+                xcb_get_property_cookie_t role;
+                xcb_get_property_cookie_t state;
+            };
+
+            QVector<Cookies> cookies;
+            cookies.reserve( requests.size() );
+            for( auto iter = requests.constBegin(); iter != requests.constEnd(); ++iter )
+            {
+                const xcb_window_t window( iter.key() );
+                Cookies request = { iter.key(), iter.value(), {0}, {0}, {0} };
+                if( request.properties & WindowClass ) request.windowClass = xcb_get_property( connection, 0, window, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 0, 512 );
+                if( request.properties & WindowRole ) request.role = xcb_get_property( connection, 0, window, m_roleAtom, XCB_ATOM_STRING, 0, 512 );
+                if( request.properties & WindowState ) request.state = xcb_get_property( connection, 0, window, m_wmStateAtom, m_wmStateAtom, 0, 1 );
+                cookies.append( request );
+            }
+
+            // read property value from reply
+            auto readValue = [connection]( xcb_get_property_cookie_t cookie )
+            {
+                QScopedPointer<xcb_get_property_reply_t, QScopedPointerPodDeleter> reply( xcb_get_property_reply( connection, cookie, nullptr ) );
+                if( !( reply && reply->format == 8 ) ) return QByteArray();
+                return QByteArray( static_cast<const char*>( xcb_get_property_value( reply.data() ) ), xcb_get_property_value_length( reply.data() ) );
+            };
+
+            // read mapping state from WM_STATE reply. 3 is IconicState
+            auto readIconic = [connection]( xcb_get_property_cookie_t cookie )
+            {
+                QScopedPointer<xcb_get_property_reply_t, QScopedPointerPodDeleter> reply( xcb_get_property_reply( connection, cookie, nullptr ) );
+                if( !( reply && reply->format == 32 && xcb_get_property_value_length( reply.data() ) >= 4 ) ) return false;
+                return *static_cast<const quint32*>( xcb_get_property_value( reply.data() ) ) == 3;
+            };
+
+            for( const Cookies& request : cookies )
+            {
+
+                // read all replies, even for windows unregistered in the meantime
+                Entry entry( m_entries.value( request.window ) );
+                Properties properties;
+
+                if( request.properties & WindowClass )
+                {
+                    // WM_CLASS holds the name and the class, null separated
+                    const QList<QByteArray> values( readValue( request.windowClass ).split( '\0' ) );
+                    const QByteArray className( values.value( 0 ) );
+                    const QByteArray classClass( values.value( 1 ) );
+                    if( className != entry.className || classClass != entry.classClass )
+                    {
+                        entry.className = className;
+                        entry.classClass = classClass;
+                        properties |= WindowClass;
+                    }
+                }
+
+                if( request.properties & WindowRole )
+                {
+                    const QByteArray role( readValue( request.role ) );
+                    if( role != entry.role )
+                    {
+                        entry.role = role;
+                        properties |= WindowRole;
+                    }
+                }
+
+                if( request.properties & WindowState )
+                {
+                    const bool iconic( readIconic( request.state ) );
+                    if( iconic != entry.iconic )
+                    {
+                        entry.iconic = iconic;
+                        properties |= WindowState;
+                    }
+                }
+
+                if( properties && m_entries.contains( request.window ) )
+                {
+                    m_entries.insert( request.window, entry );
+                    changed.insert( request.window, properties );
+                }
+
+            }
+
+            return changed;
+
+        }
+        #endif
+
+        // no direct X11 access, fall back to window system queries
+        for( auto iter = requests.constBegin(); iter != requests.constEnd(); ++iter )
+        {
+            if( !m_entries.contains( iter.key() ) ) continue;
+
+            const KWindowInfo info( iter.key(), NET::XAWMState, NET::WM2WindowClass|NET::WM2WindowRole );
+            Entry entry;
+            entry.className = info.windowClassName();
+            entry.classClass = info.windowClassClass();
+            entry.role = info.windowRole();
+            entry.iconic = info.valid() && info.mappingState() == NET::Iconic;
+
+            m_entries.insert( iter.key(), entry );
+            changed.insert( iter.key(), iter.value() );
+        }
+
+        return changed;
+
+    }
+
+}
@@ -0,0 +1,137 @@
+#ifndef breezewindowpropertycache_h
+#define breezewindowpropertycache_h
+
+/*
+ * Copyright 2018  Igor Shovkun <igshov@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QAbstractNativeEventFilter>
+#include <QByteArray>
+#include <QFlags>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <qwindowdefs.h>
+
+namespace SierraBreeze
+{
+
+    /**
+    caches the window properties used to match exceptions, for all decorated windows.
+    Properties are fetched once, in a single batch, when the window is registered,
+    then again only when X reports them as changed with a PropertyNotify event.
+    The cache is never deleted: the event filter is removed when the application is about to quit
+    */
+    class WindowPropertyCache: public QObject, public QAbstractNativeEventFilter
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* cached properties
+        enum Property
+        {
+            WindowClass = 1<<0,
+            WindowRole = 1<<1,
+            WindowState = 1<<2,
+            AllProperties = WindowClass|WindowRole|WindowState
+        };
+
+        Q_DECLARE_FLAGS( Properties, Property )
+
+        //* properties of one window
+        class Entry
+        {
+            public:
+
+            //* class name and class, as matched by exceptions
+            QString windowClass( void ) const
+            { return QString::fromUtf8( className ) + QStringLiteral(" ") + QString::fromUtf8( classClass ); }
+
+            QByteArray className;
+            QByteArray classClass;
+            QByteArray role;
+
+            //* true if the window manager iconified the window, i.e. minimized or on another desktop
+            bool iconic = false;
+        };
+
+        //* singleton
+        static WindowPropertyCache& self( void );
+
+        //* send the atom requests, in one batch, without waiting for the replies
+        static void warmUp( void );
+
+        //* destructor
+        virtual ~WindowPropertyCache( void );
+
+        //*@name windows
+        //@{
+        void registerWindow( WId );
+        void unregisterWindow( WId );
+        //@}
+
+        //* cached properties for a window. Empty if the window is not registered
+        Entry entry( WId window ) const
+        { return m_entries.value( window ); }
+
+        //* native event filter
+        bool nativeEventFilter( const QByteArray&, void*, long* ) override;
+
+        Q_SIGNALS:
+
+        //* emitted when properties of a registered window actually changed
+        void propertiesChanged( WId, SierraBreeze::WindowPropertyCache::Properties );
+
+        private Q_SLOTS:
+
+        //* fetch properties reported as changed since the last event loop turn
+        void fetchPending( void );
+
+        //* remove the event filter and drop cached properties, before the application goes away
+        void shutdown( void );
+
+        private:
+
+        //* constructor
+        WindowPropertyCache( void );
+
+        //* fetch properties of several windows in one batch, and return the ones that changed
+        QHash<WId, Properties> fetch( const QHash<WId, Properties>& );
+
+        //* cached properties, by window id
+        QHash<WId, Entry> m_entries;
+
+        //* properties waiting to be fetched, by window id
+        QHash<WId, Properties> m_pending;
+
+        //*@name atoms, interned once
+        //@{
+        quint32 m_roleAtom = 0;
+        quint32 m_wmStateAtom = 0;
+        //@}
+
+    };
+
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS( SierraBreeze::WindowPropertyCache::Properties )
+
+#endif
@@ -24,14 +24,23 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "breezeconfigwidget.h"
+#include "breezeconfigblob.h"
 #include "breezeexceptionlist.h"
 #include "breezesettings.h"
 
 #include <KLocalizedString>
+#include <KPluginFactory>
 
 #include <QDBusConnection>
 #include <QDBusMessage>
 
+K_PLUGIN_FACTORY_WITH_JSON(
+    SierraBreezeConfigFactory,
+    "kcm_sierrabreezedecoration.json",
+    registerPlugin<SierraBreeze::ConfigWidget>();
+    registerPlugin<SierraBreeze::ConfigWidget>(QStringLiteral("kcmodule"));
+)
+
 namespace SierraBreeze
 {
 
@@ -63,6 +72,7 @@ namespace SierraBreeze
         // track animations changes
         connect( m_ui.animationsEnabled, SIGNAL(clicked()), SLOT(updateChanged()) );
         connect( m_ui.animationsDuration, SIGNAL(valueChanged(int)), SLOT(updateChanged()) );
+        connect( m_ui.lowPowerMode, SIGNAL(currentIndexChanged(int)), SLOT(updateChanged()) );
 
         // track shadows changes
         connect( m_ui.shadowSize, SIGNAL(valueChanged(int)), SLOT(updateChanged()) );
@@ -79,7 +89,7 @@ namespace SierraBreeze
     {
 
         // create internal settings and load from rc files
-        m_internalSettings = InternalSettingsPtr( new InternalSettings() );
+        m_internalSettings = InternalSettingsPtr( new InternalSettings( m_configuration ) );
         m_internalSettings->load();
 
         // assign to ui
@@ -91,6 +101,7 @@ namespace SierraBreeze
         m_ui.drawBackgroundGradient->setChecked( m_internalSettings->drawBackgroundGradient() );
         m_ui.animationsEnabled->setChecked( m_internalSettings->animationsEnabled() );
         m_ui.animationsDuration->setValue( m_internalSettings->animationsDuration() );
+        m_ui.lowPowerMode->setCurrentIndex( m_internalSettings->lowPowerMode() );
         m_ui.drawTitleBarSeparator->setChecked( m_internalSettings->drawTitleBarSeparator() );
         m_ui.buttonSize->setValue( m_internalSettings->buttonSize() );
         m_ui.buttonSpacing->setValue( m_internalSettings->buttonSpacing() );
@@ -115,7 +126,7 @@ namespace SierraBreeze
     {
 
         // create internal settings and load from rc files
-        m_internalSettings = InternalSettingsPtr( new InternalSettings() );
+        m_internalSettings = InternalSettingsPtr( new InternalSettings( m_configuration ) );
         m_internalSettings->load();
 
         // apply modifications from ui
@@ -127,6 +138,7 @@ namespace SierraBreeze
         m_internalSettings->setDrawBackgroundGradient( m_ui.drawBackgroundGradient->isChecked() );
         m_internalSettings->setAnimationsEnabled( m_ui.animationsEnabled->isChecked() );
         m_internalSettings->setAnimationsDuration( m_ui.animationsDuration->value() );
+        m_internalSettings->setLowPowerMode( m_ui.lowPowerMode->currentIndex() );
         m_internalSettings->setDrawTitleBarSeparator(m_ui.drawTitleBarSeparator->isChecked());
         m_internalSettings->setMatchColorForTitleBar( m_ui.matchColorForTitleBar->isChecked() );
 
@@ -149,6 +161,9 @@ namespace SierraBreeze
         m_configuration->sync();
         setChanged( false );
 
+        // compiled configuration, read by the decoration at load
+        ConfigBlob::write( m_configuration );
+
         // needed to tell kwin to reload when running from external kcmshell
         {
             QDBusMessage message = QDBusMessage::createSignal("/KWin", "org.kde.KWin", "reloadConfig");
@@ -168,7 +183,7 @@ namespace SierraBreeze
     {
 
         // create internal settings and load from rc files
-        m_internalSettings = InternalSettingsPtr( new InternalSettings() );
+        m_internalSettings = InternalSettingsPtr( new InternalSettings( m_configuration ) );
         m_internalSettings->setDefaults();
 
         // assign to ui
@@ -179,6 +194,7 @@ namespace SierraBreeze
         m_ui.drawBackgroundGradient->setChecked( m_internalSettings->drawBackgroundGradient() );
         m_ui.animationsEnabled->setChecked( m_internalSettings->animationsEnabled() );
         m_ui.animationsDuration->setValue( m_internalSettings->animationsDuration() );
+        m_ui.lowPowerMode->setCurrentIndex( m_internalSettings->lowPowerMode() );
         m_ui.drawTitleBarSeparator->setChecked( m_internalSettings->drawTitleBarSeparator() );
 
         m_ui.buttonSize->setValue( m_internalSettings->buttonSize() );
@@ -216,6 +232,7 @@ namespace SierraBreeze
         // animations
         else if( m_ui.animationsEnabled->isChecked() !=  m_internalSettings->animationsEnabled() ) modified = true;
         else if( m_ui.animationsDuration->value() != m_internalSettings->animationsDuration() ) modified = true;
+        else if( m_ui.lowPowerMode->currentIndex() != m_internalSettings->lowPowerMode() ) modified = true;
 
         // shadows
         else if( m_ui.shadowSize->value() !=  m_internalSettings->shadowSize() ) modified = true;
@@ -239,3 +256,5 @@ namespace SierraBreeze
     }
 
 }
+
+#include "breezeconfigwidget.moc"
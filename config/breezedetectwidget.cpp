@@ -33,6 +33,8 @@
 
 #include <KWindowInfo>
 
+#include <QElapsedTimer>
+#include <QLoggingCategory>
 #include <QPushButton>
 #include <QMouseEvent>
 #include <config-breeze.h>
@@ -41,6 +43,8 @@
 #include <xcb/xcb.h>
 #endif
 
+Q_LOGGING_CATEGORY(SIERRABREEZE_DETECT, "sierrabreeze.detect", QtInfoMsg)
+
 namespace SierraBreeze
 {
 
@@ -85,7 +89,8 @@ namespace SierraBreeze
             return;
         }
 
-        m_info.reset(new KWindowInfo( window, NET::WMAllProperties, NET::WM2AllProperties ));
+        // only fetch what the exception dialog uses, and the mapping state needed by valid()
+        m_info.reset(new KWindowInfo( window, NET::WMName|NET::XAWMState, NET::WM2WindowClass|NET::WM2WindowRole ));
         if( !m_info->valid())
         {
             emit detectionDone( false );
@@ -156,25 +161,37 @@ namespace SierraBreeze
         // check atom
         if( !m_wmStateAtom ) return 0;
 
+        QElapsedTimer timer;
+        timer.start();
+
         xcb_connection_t* connection( QX11Info::connection() );
-        xcb_window_t parent( QX11Info::appRootWindow() );
+        xcb_query_pointer_cookie_t pointerCookie( xcb_query_pointer( connection, QX11Info::appRootWindow() ) );
 
         // why is there a loop of only 10 here
         for( int i = 0; i < 10; ++i )
         {
 
             // query pointer
-            xcb_query_pointer_cookie_t pointerCookie( xcb_query_pointer( connection, parent ) );
             QScopedPointer<xcb_query_pointer_reply_t, QScopedPointerPodDeleter> pointerReply( xcb_query_pointer_reply( connection, pointerCookie, nullptr ) );
             if( !( pointerReply && pointerReply->child ) ) return 0;
 
+            // send the WM_STATE check and the next level pointer query together,
+            // so that each level costs a single round trip
             const xcb_window_t child( pointerReply->child );
             xcb_get_property_cookie_t cookie( xcb_get_property( connection, 0, child, m_wmStateAtom, XCB_GET_PROPERTY_TYPE_ANY, 0, 0 ) );
+            pointerCookie = xcb_query_pointer( connection, child );
+
             QScopedPointer<xcb_get_property_reply_t, QScopedPointerPodDeleter> reply( xcb_get_property_reply( connection, cookie, nullptr ) );
-            if( reply  && reply->type ) return child;
-            else parent = child;
+            if( reply  && reply->type )
+            {
+                xcb_discard_reply( connection, pointerCookie.sequence );
+                qCInfo( SIERRABREEZE_DETECT ) << "picked window" << child << "at depth" << i+1 << "in" << timer.elapsed() << "ms";
+                return child;
+            }
 
         }
+
+        xcb_discard_reply( connection, pointerCookie.sequence );
         #endif
 
         return 0;
@@ -52,6 +52,7 @@ namespace SierraBreeze
         // connections
         connect( m_ui.exceptionType, SIGNAL(currentIndexChanged(int)), SLOT(updateChanged()) );
         connect( m_ui.exceptionEditor, SIGNAL(textChanged(QString)), SLOT(updateChanged()) );
+        connect( m_ui.exceptionPatternKind, SIGNAL(currentIndexChanged(int)), SLOT(updateChanged()) );
         connect( m_ui.borderSizeComboBox, SIGNAL(currentIndexChanged(int)), SLOT(updateChanged()) );
 
         for( CheckBoxMap::iterator iter = m_checkboxes.begin(); iter != m_checkboxes.end(); ++iter )
@@ -77,6 +78,7 @@ namespace SierraBreeze
         // type
         m_ui.exceptionType->setCurrentIndex(m_exception->exceptionType() );
         m_ui.exceptionEditor->setText( m_exception->exceptionPattern() );
+        m_ui.exceptionPatternKind->setCurrentIndex( m_exception->exceptionPatternKind() );
         m_ui.borderSizeComboBox->setCurrentIndex( m_exception->borderSize() );
         m_ui.hideTitleBar->setChecked( m_exception->hideTitleBar() );
 
@@ -93,6 +95,7 @@ namespace SierraBreeze
     {
         m_exception->setExceptionType( m_ui.exceptionType->currentIndex() );
         m_exception->setExceptionPattern( m_ui.exceptionEditor->text() );
+        m_exception->setExceptionPatternKind( m_ui.exceptionPatternKind->currentIndex() );
         m_exception->setBorderSize( m_ui.borderSizeComboBox->currentIndex() );
         m_exception->setHideTitleBar( m_ui.hideTitleBar->isChecked() );
 
@@ -113,6 +116,7 @@ namespace SierraBreeze
         bool modified( false );
         if( m_exception->exceptionType() != m_ui.exceptionType->currentIndex() ) modified = true;
         else if( m_exception->exceptionPattern() != m_ui.exceptionEditor->text() ) modified = true;
+        else if( m_exception->exceptionPatternKind() != m_ui.exceptionPatternKind->currentIndex() ) modified = true;
         else if( m_exception->borderSize() != m_ui.borderSizeComboBox->currentIndex() ) modified = true;
         else if( m_exception->hideTitleBar() != m_ui.hideTitleBar->isChecked() ) modified = true;
         else
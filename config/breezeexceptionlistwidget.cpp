@@ -30,6 +30,7 @@
 
 #include <QMessageBox>
 #include <QPointer>
+#include <QRegularExpression>
 #include <QIcon>
 
 //__________________________________________________________
@@ -110,7 +111,7 @@ namespace SierraBreeze
 
         QPointer<ExceptionDialog> dialog = new ExceptionDialog( this );
         dialog->setWindowTitle( i18n( "New Exception - Breeze Settings" ) );
-        InternalSettingsPtr exception( new InternalSettings() );
+        InternalSettingsPtr exception( new InternalSettings( KSharedConfig::openConfig( QStringLiteral( "breezerc" ) ) ) );
 
         exception->load();
 
@@ -326,6 +327,7 @@ namespace SierraBreeze
     {
         m_ui.exceptionListView->resizeColumnToContents( ExceptionModel::ColumnEnabled );
         m_ui.exceptionListView->resizeColumnToContents( ExceptionModel::ColumnType );
+        m_ui.exceptionListView->resizeColumnToContents( ExceptionModel::ColumnPatternKind );
         m_ui.exceptionListView->resizeColumnToContents( ExceptionModel::ColumnRegExp );
     }
 
@@ -333,7 +335,9 @@ namespace SierraBreeze
     bool ExceptionListWidget::checkException( InternalSettingsPtr exception )
     {
 
-        while( exception->exceptionPattern().isEmpty() || !QRegExp( exception->exceptionPattern() ).isValid() )
+        // only regular expressions have a syntax to check
+        while( exception->exceptionPattern().isEmpty() ||
+            ( exception->exceptionPatternKind() == InternalSettings::ExceptionPatternRegExp && !QRegularExpression( exception->exceptionPattern() ).isValid() ) )
         {
 
             QMessageBox::warning( this, i18n( "Warning - Breeze Settings" ), i18n("Regular Expression syntax is incorrect") );
@@ -35,7 +35,8 @@ namespace SierraBreeze
     {
         QStringLiteral( "" ),
         i18n("Exception Type"),
-        i18n("Regular Expression")
+        i18n("Pattern Kind"),
+        i18n("Pattern")
     };
 
     //__________________________________________________________________
@@ -69,6 +70,24 @@ namespace SierraBreeze
 
                 }
 
+                case ColumnPatternKind:
+                {
+                    switch( configuration->exceptionPatternKind() )
+                    {
+
+                        case InternalSettings::ExceptionPatternLiteral:
+                        return i18n( "Plain Text" );
+
+                        case InternalSettings::ExceptionPatternGlob:
+                        return i18n( "Wildcards" );
+
+                        default:
+                        case InternalSettings::ExceptionPatternRegExp:
+                        return i18n( "Regular Expression" );
+                    }
+
+                }
+
                 case ColumnRegExp: return configuration->exceptionPattern();
                 default: return QVariant();
                 break;
@@ -39,12 +39,13 @@ namespace SierraBreeze
         public:
 
         //* number of columns
-        enum { nColumns = 3 };
+        enum { nColumns = 4 };
 
         //* column type enumeration
         enum ColumnType {
             ColumnEnabled,
             ColumnType,
+            ColumnPatternKind,
             ColumnRegExp
         };
 